@@ -0,0 +1,145 @@
+#pragma once
+#include "HashMap.h"
+#include <cstdint>
+#include <mutex>
+#include <new>
+
+/*
+* A set using hashing that any number of threads can use at once, for duplicate detection shared between the threads of a search.
+* Items are spread over stripes by their hash and each stripe is a Robin Hood HashMap behind its own lock, so threads only wait for each
+* other when they use the same stripe. A stripe grows on its own while it is locked, so the threads using the rest of the table carry on
+* and the work of growing the table is shared out between the threads that fill it.
+* Nothing hands out pointers, references or iterators into the set as another thread could move the item at any time, so items are only
+* ever copied in and looked at through a function called while their stripe is locked.
+*/
+template<class T, class Hasher = std::hash<T>, class EqualTo = std::equal_to<T>>
+class ConcurrentHashMap
+{
+public:
+	using value_type = T;
+	using size_type = size_t;
+	using reference = value_type&;
+	using const_reference = const value_type&;
+private:
+	constexpr static size_t cacheLineSize = 64u;
+
+	//Each stripe starts on a new cache line so threads locking neighbouring stripes don't slow each other down
+	struct Stripe
+	{
+		std::mutex mutex;
+		HashMap<T, Hasher, EqualTo> items;
+	};
+	constexpr static size_t stripeSize = (sizeof(Stripe) + cacheLineSize - 1u) / cacheLineSize * cacheLineSize;
+
+	Hasher hasher;
+	std::unique_ptr<char[]> storage;
+	Stripe* stripes;
+	size_type stripeCount;
+
+	/*
+	* The stripes use different bits of the hash than the HashMaps in them so the items of each stripe still spread over its HashMap.
+	*/
+	Stripe& stripeFor(const_reference value) const
+	{
+		const uint64_t hash = (uint64_t)hasher(value);
+		const size_type index = (size_type)(((hash ^ (hash >> 29u)) * 0xBF58476D1CE4E5B9u) >> 40u) & (stripeCount - 1u);
+		return *reinterpret_cast<Stripe*>(reinterpret_cast<char*>(stripes) + index * stripeSize);
+	}
+
+	Stripe& stripeAt(size_type index) const
+	{
+		return *reinterpret_cast<Stripe*>(reinterpret_cast<char*>(stripes) + index * stripeSize);
+	}
+public:
+	/*
+	* minimumStripeCount is rounded up to a power of two. A few times more stripes than threads keeps the threads from waiting for each other.
+	*/
+	explicit ConcurrentHashMap(size_type minimumStripeCount = 256u) : stripeCount(1u)
+	{
+		while (stripeCount < minimumStripeCount) stripeCount *= 2u;
+		storage.reset(new char[stripeCount * stripeSize + cacheLineSize - 1u]);
+		const uintptr_t address = reinterpret_cast<uintptr_t>(storage.get());
+		stripes = reinterpret_cast<Stripe*>((address + cacheLineSize - 1u) / cacheLineSize * cacheLineSize);
+		for (size_type i = 0u; i != stripeCount; ++i)
+		{
+			new(&stripeAt(i)) Stripe();
+		}
+	}
+
+	ConcurrentHashMap(const ConcurrentHashMap&) = delete;
+	ConcurrentHashMap& operator=(const ConcurrentHashMap&) = delete;
+
+	~ConcurrentHashMap()
+	{
+		for (size_type i = 0u; i != stripeCount; ++i)
+		{
+			stripeAt(i).~Stripe();
+		}
+	}
+
+	/*
+	* Adds value unless an equal item is already in the set. Returns true if value was added.
+	*/
+	bool insert(const_reference value)
+	{
+		Stripe& stripe = stripeFor(value);
+		std::lock_guard<std::mutex> lock(stripe.mutex);
+		if (stripe.items.find(value) != stripe.items.end()) return false;
+		stripe.items.insert(value);
+		return true;
+	}
+
+	/*
+	* Adds value unless an equal item is already in the set, in which case update is called on that item while no other thread can use it
+	* and may change anything that doesn't affect its hash. Returns true if value was added.
+	*/
+	template<class Update>
+	bool insertOrUpdate(const_reference value, Update update)
+	{
+		Stripe& stripe = stripeFor(value);
+		std::lock_guard<std::mutex> lock(stripe.mutex);
+		auto existing = stripe.items.find(value);
+		if (existing != stripe.items.end())
+		{
+			update(*existing);
+			return false;
+		}
+		stripe.items.insert(value);
+		return true;
+	}
+
+	bool contains(const_reference value) const
+	{
+		Stripe& stripe = stripeFor(value);
+		std::lock_guard<std::mutex> lock(stripe.mutex);
+		return stripe.items.find(value) != stripe.items.end();
+	}
+
+	/*
+	* Copies the item equal to value into result. Returns false if there isn't one.
+	*/
+	bool find(const_reference value, reference result) const
+	{
+		Stripe& stripe = stripeFor(value);
+		std::lock_guard<std::mutex> lock(stripe.mutex);
+		auto existing = stripe.items.find(value);
+		if (existing == stripe.items.end()) return false;
+		result = *existing;
+		return true;
+	}
+
+	/*
+	* The number of items in the set. Only exact while no other thread is inserting.
+	*/
+	size_type size() const
+	{
+		size_type total = 0u;
+		for (size_type i = 0u; i != stripeCount; ++i)
+		{
+			Stripe& stripe = stripeAt(i);
+			std::lock_guard<std::mutex> lock(stripe.mutex);
+			total += stripe.items.size();
+		}
+		return total;
+	}
+};
@@ -151,7 +151,7 @@ private:
 
 	void rehashNoChecks(size_type newCapacity)
 	{
-		if (capacity == 0u)
+		if (newCapacity == 0u)
 		{
 			newCapacity = 8u;
 		}
@@ -190,12 +190,39 @@ private:
 			std::allocator<Node>().deallocate(oldData, oldCapacity + 1u);
 		}
 	}
+
+	Node* findNode(const_reference value) const
+	{
+		if (capacity == 0u) return nullptr;
+		auto hash = hasher(value);
+		Node* bucket = data + (hash & (capacity - 1));
+		size_type distanceFromIdealBucket = 1u;
+		Node* const endData = data + capacity;
+		while (bucket->distanceFromIdealPosition() >= distanceFromIdealBucket)
+		{
+			if(bucket->distanceFromIdealPosition() == distanceFromIdealBucket && equal(bucket->data(), value)) return bucket;
+			++bucket;
+			if (bucket == endData) bucket = data;
+			++distanceFromIdealBucket;
+		}
+		
+		return endData;
+	}
 public:
 	using iterator = Iterator<value_type>;
 	using const_iterator = Iterator<const value_type>;
 
 	HashMap() noexcept {}
 
+	/*
+	* Starts with bucketCount buckets, which must be a power of two. Only insert grows the table, so a HashMap only filled with
+	* insertBounded keeps exactly this many.
+	*/
+	explicit HashMap(size_type bucketCount)
+	{
+		rehashNoChecks(bucketCount);
+	}
+
 	HashMap(HashMap&& other) noexcept
 	{
 		data = other.data;
@@ -332,22 +359,53 @@ public:
 		}
 	}
 
-	iterator find(const_reference value)
+	/*
+	* Inserts a value that isn't already in the table without ever growing it, so the table must already have buckets.
+	* No value is placed more than maxDistance buckets past its ideal bucket. When the value being placed gets that far and the bucket
+	* holds a value just as far from its own ideal bucket, keepNew(occupant, value) decides whether value replaces the occupant and the
+	* other one is dropped.
+	*/
+	template<class KeepNew>
+	void insertBounded(value_type value, size_type maxDistance, KeepNew keepNew)
 	{
-		if (capacity == 0u) return iterator(nullptr);
 		auto hash = hasher(value);
 		Node* bucket = data + (hash & (capacity - 1));
 		size_type distanceFromIdealBucket = 1u;
 		Node* const endData = data + capacity;
-		while (bucket->distanceFromIdealPosition() >= distanceFromIdealBucket)
+		while (true)
 		{
-			if(bucket->distanceFromIdealPosition() == distanceFromIdealBucket && equal(bucket->data(), value)) return iterator(bucket);
+			if (bucket->distanceFromIdealPosition() == 0)
+			{
+				bucket->data() = std::move(value);
+				bucket->distanceFromIdealPosition() = distanceFromIdealBucket;
+				++mSize;
+				break;
+			}
+			else if (bucket->distanceFromIdealPosition() < distanceFromIdealBucket)
+			{
+				std::swap(value, bucket->data());
+				std::swap(bucket->distanceFromIdealPosition(), distanceFromIdealBucket);
+			}
+			else if (distanceFromIdealBucket == maxDistance)
+			{
+				if (keepNew(bucket->data(), value)) bucket->data() = std::move(value);
+				break;
+			}
+
 			++bucket;
 			if (bucket == endData) bucket = data;
 			++distanceFromIdealBucket;
 		}
-		
-		return iterator(endData);
+	}
+
+	iterator find(const_reference value)
+	{
+		return iterator(findNode(value));
+	}
+
+	const_iterator find(const_reference value) const
+	{
+		return const_iterator(findNode(value));
 	}
 
 	void clear()
@@ -361,6 +419,7 @@ public:
 				current->distanceFromIdealPosition() = 0u;
 			}
 		}
+		mSize = 0u;
 	}
 
 	void erase(const_iterator pos)
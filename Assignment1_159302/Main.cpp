@@ -20,6 +20,12 @@
 #include <iomanip>
 #include <algorithm> //used by transform - to lower case
 #include <exception>
+#include <fstream>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <memory>
 
 #include "graphics.h"
 #include "algorithm.h"
@@ -268,6 +274,437 @@ void AnimateSolution(string const& initialState, string const& goalState, string
 
 
 
+/**
+ * Runs the algorithm named algorithmSelected (in lower case) and returns the path it found.
+ * Returns "" if there is no algorithm with that name. If cancellation isn't null the search stops once it is and returns "TIMEOUT" or "CANCELLED".
+ */
+string runAlgorithm(string const& algorithmSelected, string const& initialState, string const& goalState, int& numOfStateExpansions, int& maxQLength,
+                    float& actualRunningTime, int& numOfDeletionsFromMiddleOfHeap, int& numOfLocalLoopsAvoided, int& numOfAttemptedNodeReExpansions,
+                    const CancellationToken* cancellation){
+
+    string path;
+
+    if(algorithmSelected == "breadth_first_search" ){
+        
+        path = breadthFirstSearch(initialState, goalState, numOfStateExpansions, maxQLength, actualRunningTime, cancellation);
+
+    } else if(algorithmSelected == "breadth_first_search_vlist" ){
+        
+        path = breadthFirstSearch_with_VisitedList(initialState, goalState, numOfStateExpansions, maxQLength, actualRunningTime, cancellation);    
+                          
+
+    } else if(algorithmSelected == "pds_no_vlist" ){			
+		
+		path = progressiveDeepeningSearch_No_VisitedList(initialState,  goalState, numOfStateExpansions, maxQLength, actualRunningTime, 5000, cancellation);		
+
+    } else if(algorithmSelected == "pds_nonstrict_vlist" ){
+        path = progressiveDeepeningSearch_with_NonStrict_VisitedList(initialState, goalState, numOfStateExpansions, maxQLength, actualRunningTime,5000, cancellation);
+    	
+	
+    }  else if(algorithmSelected == "astar_explist_misplacedtiles" ){       
+        
+        path = aStar_ExpandedList(initialState, goalState, numOfStateExpansions, maxQLength, actualRunningTime, numOfDeletionsFromMiddleOfHeap,numOfLocalLoopsAvoided ,numOfAttemptedNodeReExpansions, misplacedTiles, 0, cancellation);     
+
+    }  else if(algorithmSelected == "astar_explist_manhattan" ){       
+        
+        path = aStar_ExpandedList(initialState, goalState, numOfStateExpansions, maxQLength, actualRunningTime, numOfDeletionsFromMiddleOfHeap,numOfLocalLoopsAvoided ,numOfAttemptedNodeReExpansions, manhattanDistance, 0, cancellation); 
+        
+    }  else if(algorithmSelected == "rbfs_misplacedtiles" ){       
+        
+        path = recursiveBestFirstSearch(initialState, goalState, numOfStateExpansions, maxQLength, actualRunningTime, misplacedTiles, 0, cancellation); 
+        
+    }  else if(algorithmSelected == "rbfs_manhattan" ){       
+        
+        path = recursiveBestFirstSearch(initialState, goalState, numOfStateExpansions, maxQLength, actualRunningTime, manhattanDistance, 0, cancellation); 
+        
+    }  else if(algorithmSelected == "fringe_misplacedtiles" ){       
+        
+        path = fringeSearch(initialState, goalState, numOfStateExpansions, maxQLength, actualRunningTime, misplacedTiles, cancellation); 
+        
+    }  else if(algorithmSelected == "fringe_manhattan" ){       
+        
+        path = fringeSearch(initialState, goalState, numOfStateExpansions, maxQLength, actualRunningTime, manhattanDistance, cancellation); 
+        
+    }  else if(algorithmSelected == "idastar_misplacedtiles" ){       
+        
+        path = iterativeDeepeningAStar(initialState, goalState, numOfStateExpansions, maxQLength, actualRunningTime, misplacedTiles, 0, 0, cancellation); 
+        
+    }  else if(algorithmSelected == "idastar_manhattan" ){       
+        
+        path = iterativeDeepeningAStar(initialState, goalState, numOfStateExpansions, maxQLength, actualRunningTime, manhattanDistance, 0, 0, cancellation); 
+        
+    }  else if(algorithmSelected == "idastar_tt_misplacedtiles" ){       
+        
+        path = iterativeDeepeningAStar(initialState, goalState, numOfStateExpansions, maxQLength, actualRunningTime, misplacedTiles, 16 * 1024 * 1024, 0, cancellation); 
+        
+    }  else if(algorithmSelected == "idastar_tt_manhattan" ){       
+        
+        path = iterativeDeepeningAStar(initialState, goalState, numOfStateExpansions, maxQLength, actualRunningTime, manhattanDistance, 16 * 1024 * 1024, 0, cancellation); 
+        
+    }  else if(algorithmSelected == "astar_explist_linearconflict" ){       
+        
+        path = aStar_ExpandedList(initialState, goalState, numOfStateExpansions, maxQLength, actualRunningTime, numOfDeletionsFromMiddleOfHeap, numOfLocalLoopsAvoided, numOfAttemptedNodeReExpansions, linearConflict, 0, cancellation); 
+        
+    }  else if(algorithmSelected == "idastar_linearconflict" ){       
+        
+        path = iterativeDeepeningAStar(initialState, goalState, numOfStateExpansions, maxQLength, actualRunningTime, linearConflict, 0, 0, cancellation); 
+        
+    }  else if(algorithmSelected == "astar_explist_walkingdistance" ){       
+        
+        path = aStar_ExpandedList(initialState, goalState, numOfStateExpansions, maxQLength, actualRunningTime, numOfDeletionsFromMiddleOfHeap, numOfLocalLoopsAvoided, numOfAttemptedNodeReExpansions, walkingDistance, 0, cancellation); 
+        
+    }  else if(algorithmSelected == "idastar_walkingdistance" ){       
+        
+        path = iterativeDeepeningAStar(initialState, goalState, numOfStateExpansions, maxQLength, actualRunningTime, walkingDistance, 0, 0, cancellation); 
+        
+    }  else if(algorithmSelected == "astar_explist_patterndatabase" ){       
+        
+        path = aStar_ExpandedList(initialState, goalState, numOfStateExpansions, maxQLength, actualRunningTime, numOfDeletionsFromMiddleOfHeap, numOfLocalLoopsAvoided, numOfAttemptedNodeReExpansions, patternDatabase, 0, cancellation); 
+        
+    }  else if(algorithmSelected == "idastar_patterndatabase" ){       
+        
+        path = iterativeDeepeningAStar(initialState, goalState, numOfStateExpansions, maxQLength, actualRunningTime, patternDatabase, 0, 0, cancellation); 
+        
+    }  else if(algorithmSelected == "astar_explist_dualpatterndatabase" ){       
+        
+        path = aStar_ExpandedList(initialState, goalState, numOfStateExpansions, maxQLength, actualRunningTime, numOfDeletionsFromMiddleOfHeap, numOfLocalLoopsAvoided, numOfAttemptedNodeReExpansions, dualPatternDatabase, 0, cancellation); 
+        
+    }  else if(algorithmSelected == "idastar_dualpatterndatabase" ){       
+        
+        path = iterativeDeepeningAStar(initialState, goalState, numOfStateExpansions, maxQLength, actualRunningTime, dualPatternDatabase, 0, 0, cancellation); 
+        
+    }  else if(algorithmSelected == "lazyastar_explist_walkingdistance" ){       
+        
+        path = lazyAStar_ExpandedList(initialState, goalState, numOfStateExpansions, maxQLength, actualRunningTime, numOfDeletionsFromMiddleOfHeap, numOfLocalLoopsAvoided, numOfAttemptedNodeReExpansions, walkingDistance, cancellation); 
+        
+    }  else if(algorithmSelected == "lazyastar_explist_patterndatabase" ){       
+        
+        path = lazyAStar_ExpandedList(initialState, goalState, numOfStateExpansions, maxQLength, actualRunningTime, numOfDeletionsFromMiddleOfHeap, numOfLocalLoopsAvoided, numOfAttemptedNodeReExpansions, patternDatabase, cancellation); 
+        
+    }  else if(algorithmSelected == "epeastar_explist_misplacedtiles" ){       
+        
+        path = partialExpansionAStar_ExpandedList(initialState, goalState, numOfStateExpansions, maxQLength, actualRunningTime, numOfDeletionsFromMiddleOfHeap, numOfLocalLoopsAvoided, numOfAttemptedNodeReExpansions, misplacedTiles, cancellation); 
+        
+    }  else if(algorithmSelected == "epeastar_explist_manhattan" ){       
+        
+        path = partialExpansionAStar_ExpandedList(initialState, goalState, numOfStateExpansions, maxQLength, actualRunningTime, numOfDeletionsFromMiddleOfHeap, numOfLocalLoopsAvoided, numOfAttemptedNodeReExpansions, manhattanDistance, cancellation); 
+        
+    }  else if(algorithmSelected == "astar_explist_manhattan_perimeter" ){       
+        
+        path = aStar_ExpandedList(initialState, goalState, numOfStateExpansions, maxQLength, actualRunningTime, numOfDeletionsFromMiddleOfHeap, numOfLocalLoopsAvoided, numOfAttemptedNodeReExpansions, manhattanDistance, 12, cancellation); 
+        
+    }  else if(algorithmSelected == "rbfs_manhattan_perimeter" ){       
+        
+        path = recursiveBestFirstSearch(initialState, goalState, numOfStateExpansions, maxQLength, actualRunningTime, manhattanDistance, 12, cancellation); 
+        
+    }  else if(algorithmSelected == "idastar_manhattan_perimeter" ){       
+        
+        path = iterativeDeepeningAStar(initialState, goalState, numOfStateExpansions, maxQLength, actualRunningTime, manhattanDistance, 0, 12, cancellation); 
+        
+    }  else if(algorithmSelected == "breadth_first_search_vlist_parallel" ){       
+        
+        path = breadthFirstSearch_with_VisitedList_Parallel(initialState, goalState, numOfStateExpansions, maxQLength, actualRunningTime, 0, cancellation); 
+        
+    }  else if(algorithmSelected == "hdastar_manhattan" ){       
+        
+        path = hashDistributedAStar(initialState, goalState, numOfStateExpansions, maxQLength, actualRunningTime, numOfDeletionsFromMiddleOfHeap, numOfLocalLoopsAvoided, numOfAttemptedNodeReExpansions, manhattanDistance, 0, cancellation); 
+        
+    }  else if(algorithmSelected == "idastar_parallel_manhattan" ){       
+        
+        path = parallelIterativeDeepeningAStar(initialState, goalState, numOfStateExpansions, maxQLength, actualRunningTime, manhattanDistance, 0, cancellation); 
+        
+    }  else if(algorithmSelected == "distributed_astar_manhattan" ){       
+        
+        path = distributedAStar(initialState, goalState, numOfStateExpansions, maxQLength, actualRunningTime, numOfDeletionsFromMiddleOfHeap, numOfLocalLoopsAvoided, numOfAttemptedNodeReExpansions, manhattanDistance, 0, cancellation); 
+        
+    }  else if(algorithmSelected == "multiqueue_astar_manhattan" ){       
+        
+        path = multiQueueAStar(initialState, goalState, numOfStateExpansions, maxQLength, actualRunningTime, numOfDeletionsFromMiddleOfHeap, numOfLocalLoopsAvoided, numOfAttemptedNodeReExpansions, manhattanDistance, 0, cancellation); 
+        
+    }  else if(algorithmSelected == "bidirectional_bfs" ){       
+        
+        path = bidirectionalBreadthFirstSearch(initialState, goalState, numOfStateExpansions, maxQLength, actualRunningTime, cancellation); 
+        
+    }  else if(algorithmSelected == "portfolio" ){       
+        
+        path = portfolioSearch(initialState, goalState, numOfStateExpansions, maxQLength, actualRunningTime, numOfDeletionsFromMiddleOfHeap, numOfLocalLoopsAvoided, numOfAttemptedNodeReExpansions, manhattanDistance, cancellation); 
+        
+    }  else if(algorithmSelected == "auto" ){       
+        
+        path = autoSearch(initialState, goalState, numOfStateExpansions, maxQLength, actualRunningTime, numOfDeletionsFromMiddleOfHeap, numOfLocalLoopsAvoided, numOfAttemptedNodeReExpansions, cancellation); 
+        
+    }
+
+    return path;
+}
+
+/**
+ * The numbered name printed in the results of the algorithm named algorithmSelected (in lower case), or "" if there is no algorithm with that name.
+ */
+string algorithmLabel(string const& algorithmSelected){
+
+    if(algorithmSelected == "breadth_first_search" ){
+        return "1) breadth_first_search";                    
+
+    } else if(algorithmSelected == "breadth_first_search_vlist" ){
+        return "2) breadth_first_search_vlist";             
+    
+    } else if(algorithmSelected == "pds_no_vlist" ){
+        return "3) pds_no_vlist";                  
+     
+    } else if(algorithmSelected == "pds_nonstrict_vlist" ){
+        return "4) pds_nonstrict_vlist";              
+    
+    }  else if(algorithmSelected == "astar_explist_misplacedtiles" ){
+        return "5) astar_explist_misplacedtiles";         
+        
+    }  else if(algorithmSelected == "astar_explist_manhattan" ){
+        return "6) astar_explist_manhattan";  
+
+    }  else if(algorithmSelected == "rbfs_misplacedtiles" ){
+        return "7) rbfs_misplacedtiles";  
+
+    }  else if(algorithmSelected == "rbfs_manhattan" ){
+        return "8) rbfs_manhattan";  
+
+    }  else if(algorithmSelected == "fringe_misplacedtiles" ){
+        return "9) fringe_misplacedtiles";  
+
+    }  else if(algorithmSelected == "fringe_manhattan" ){
+        return "10) fringe_manhattan";  
+
+    }  else if(algorithmSelected == "idastar_misplacedtiles" ){
+        return "11) idastar_misplacedtiles";  
+
+    }  else if(algorithmSelected == "idastar_manhattan" ){
+        return "12) idastar_manhattan";  
+
+    }  else if(algorithmSelected == "idastar_tt_misplacedtiles" ){
+        return "13) idastar_tt_misplacedtiles";  
+
+    }  else if(algorithmSelected == "idastar_tt_manhattan" ){
+        return "14) idastar_tt_manhattan";  
+
+    }  else if(algorithmSelected == "astar_explist_linearconflict" ){
+        return "15) astar_explist_linearconflict";  
+
+    }  else if(algorithmSelected == "idastar_linearconflict" ){
+        return "16) idastar_linearconflict";  
+
+    }  else if(algorithmSelected == "astar_explist_walkingdistance" ){
+        return "17) astar_explist_walkingdistance";  
+
+    }  else if(algorithmSelected == "idastar_walkingdistance" ){
+        return "18) idastar_walkingdistance";  
+
+    }  else if(algorithmSelected == "astar_explist_patterndatabase" ){
+        return "19) astar_explist_patterndatabase";  
+
+    }  else if(algorithmSelected == "idastar_patterndatabase" ){
+        return "20) idastar_patterndatabase";  
+
+    }  else if(algorithmSelected == "astar_explist_dualpatterndatabase" ){
+        return "21) astar_explist_dualpatterndatabase";  
+
+    }  else if(algorithmSelected == "idastar_dualpatterndatabase" ){
+        return "22) idastar_dualpatterndatabase";  
+
+    }  else if(algorithmSelected == "lazyastar_explist_walkingdistance" ){
+        return "23) lazyastar_explist_walkingdistance";  
+
+    }  else if(algorithmSelected == "lazyastar_explist_patterndatabase" ){
+        return "24) lazyastar_explist_patterndatabase";  
+
+    }  else if(algorithmSelected == "epeastar_explist_misplacedtiles" ){
+        return "25) epeastar_explist_misplacedtiles";  
+
+    }  else if(algorithmSelected == "epeastar_explist_manhattan" ){
+        return "26) epeastar_explist_manhattan";  
+
+    }  else if(algorithmSelected == "astar_explist_manhattan_perimeter" ){
+        return "27) astar_explist_manhattan_perimeter";  
+
+    }  else if(algorithmSelected == "rbfs_manhattan_perimeter" ){
+        return "28) rbfs_manhattan_perimeter";  
+
+    }  else if(algorithmSelected == "idastar_manhattan_perimeter" ){
+        return "29) idastar_manhattan_perimeter";  
+
+    }  else if(algorithmSelected == "breadth_first_search_vlist_parallel" ){
+        return "30) breadth_first_search_vlist_parallel";  
+
+    }  else if(algorithmSelected == "hdastar_manhattan" ){
+        return "31) hdastar_manhattan";  
+
+    }  else if(algorithmSelected == "idastar_parallel_manhattan" ){
+        return "32) idastar_parallel_manhattan";  
+
+    }  else if(algorithmSelected == "distributed_astar_manhattan" ){
+        return "33) distributed_astar_manhattan";  
+
+    }  else if(algorithmSelected == "multiqueue_astar_manhattan" ){
+        return "34) multiqueue_astar_manhattan";  
+
+    }  else if(algorithmSelected == "bidirectional_bfs" ){
+        return "35) bidirectional_bfs";  
+
+    }  else if(algorithmSelected == "portfolio" ){
+        return "36) portfolio";  
+
+    }  else if(algorithmSelected == "auto" ){
+        return "37) auto";  
+    }      
+
+    return "";
+}
+
+/**
+ * A token that stops a search timeLimit seconds from now, or null if timeLimit isn't positive so the search has no time limit.
+ */
+CancellationToken* newDeadline(double timeLimit){
+
+    if(timeLimit <= 0) return nullptr;
+    return new CancellationToken(chrono::duration_cast<chrono::steady_clock::duration>(chrono::duration<double>(timeLimit)));
+}
+
+/**
+ * Returns true if path is a solution rather than the reason there isn't one.
+ */
+bool isSolution(string const& path){
+
+    return path != "" && path != "OOM" && path != "TIMEOUT" && path != "CANCELLED";
+}
+
+/**
+ * Prints why no solution was found, if none was.
+ */
+void printNoSolution(ostream& out, string const& path){
+
+    if(path == "") out << "\n\n*---- NO SOLUTION found. (Q is empty!) ----*" << endl;    
+	else if(path == "OOM") out << "\n\n*---- NO SOLUTION found. (Out of memory!) ----*" << endl;
+	else if(path == "TIMEOUT") out << "\n\n*---- NO SOLUTION found. (Timed out!) ----*" << endl;
+	else if(path == "CANCELLED") out << "\n\n*---- NO SOLUTION found. (Cancelled!) ----*" << endl;
+}
+
+/**
+ * Prints the numbers of a run as a row of the batch_run table, lined up under the algorithm's label even if printNoSolution ended the line.
+ */
+void printBatchRow(ostream& out, string const& path, int pathLength, int numOfStateExpansions, int maxQLength, float actualRunningTime,
+                   int numOfDeletionsFromMiddleOfHeap, int numOfAttemptedNodeReExpansions){
+
+		if (!isSolution(path)) {
+			for (int i = 0; i < 31; ++i) {
+				out << " ";
+			}
+		}
+		out  << setprecision(6) << std::setfill(' ')   << std::fixed << std::right << ' ' << setw(10) << pathLength; 
+		out  << setprecision(6) << std::setfill(' ')   << std::fixed << std::right << ' ' <<  setw(10) << numOfStateExpansions; 
+		out  << setprecision(6) << std::setfill(' ')   << std::fixed << std::right << ' ' <<  setw(19) << maxQLength; 
+		out  << setprecision(6) << std::setfill(' ')   << std::fixed << std::right << ' ' <<  setw(15) << actualRunningTime; 
+        out  << setprecision(6) << std::setfill(' ')   << std::fixed << std::right << ' ' <<  setw(15) << numOfDeletionsFromMiddleOfHeap; 
+        out  << setprecision(6) << std::setfill(' ')   << std::fixed << std::right << ' ' <<  setw(15) << numOfAttemptedNodeReExpansions << endl; 
+}
+
+/**
+ * Solves every puzzle in a file of "ALGORITHM_NAME INITIAL_STATE GOAL_STATE" lines, or in the standard input if fileName is "-", without
+ * starting a process for each one. threadCount threads (one per core if 0) each take the next line not yet taken, and the results are
+ * printed in the batch_run format in the order of the lines as soon as every line before them is done.
+ * Empty lines and lines starting with # are skipped. The tables the heuristics use are shared by the threads and the few most recently
+ * used are kept for later lines with the same goal. Each thread also keeps the node memory its searches free and reuses it for its next
+ * line, but the open and closed lists of each search are still made fresh.
+ * Times are wall clock time around each search since the engines that use clock() would count the CPU time of every thread.
+ * If timeLimit is positive each search is given that many seconds.
+ */
+int runBatchFile(string const& fileName, unsigned int threadCount, double timeLimit){
+
+    ifstream file;
+    istream* input = &cin;
+    if(fileName != "-"){
+        file.open(fileName.c_str());
+        if(!file){
+            cout << "Can't open " << fileName << endl;
+            return 1;
+        }
+        input = &file;
+    }
+
+    vector<string> lines;
+    string line;
+    while(getline(*input, line)){
+        size_t first = line.find_first_not_of(" \t\r");
+        if(first != string::npos && line[first] != '#') lines.push_back(line);
+    }
+
+    vector<string> results(lines.size());
+    vector<bool> finished(lines.size(), false);
+    size_t nextToPrint = 0;
+    mutex outputMutex;
+    atomic<size_t> nextLine(0);
+
+    auto work = [&](){
+        size_t i;
+        while((i = nextLine++) < lines.size()){
+            ostringstream out;
+            string algorithmSelected, initialState, goalState;
+            istringstream fields(lines[i]);
+            fields >> algorithmSelected >> initialState >> goalState;
+            std::transform(algorithmSelected.begin(), algorithmSelected.end(), algorithmSelected.begin(), ::tolower);
+            string label = algorithmLabel(algorithmSelected);
+
+            if(goalState == ""){
+                out << "Expected ALGORITHM_NAME INITIAL_STATE GOAL_STATE: " << lines[i] << endl;
+            } else if(label == ""){
+                out << "Unknown algorithm: " << algorithmSelected << endl;
+            } else {
+                string path;
+                int numOfStateExpansions=0;
+                int maxQLength=0;
+                int numOfDeletionsFromMiddleOfHeap=0;
+                int numOfLocalLoopsAvoided=0;
+                int numOfAttemptedNodeReExpansions=0;
+                float actualRunningTime=0.0;
+                try{
+                    unique_ptr<CancellationToken> deadline(newDeadline(timeLimit));
+                    const chrono::steady_clock::time_point start = chrono::steady_clock::now();
+                    path = runAlgorithm(algorithmSelected, initialState, goalState, numOfStateExpansions, maxQLength, actualRunningTime,
+                                        numOfDeletionsFromMiddleOfHeap, numOfLocalLoopsAvoided, numOfAttemptedNodeReExpansions, deadline.get());
+                    actualRunningTime = chrono::duration<float>(chrono::steady_clock::now() - start).count();
+                    out << setw(31) << std::left << label;
+                }
+                catch(exception &e){
+                    out << "Standard exception: " << e.what() << endl;
+                }
+                printNoSolution(out, path);
+                printBatchRow(out, path, isSolution(path) ? path.size() : 0, numOfStateExpansions, maxQLength, actualRunningTime, numOfDeletionsFromMiddleOfHeap, numOfAttemptedNodeReExpansions);
+            }
+
+            lock_guard<mutex> lock(outputMutex);
+            results[i] = out.str();
+            finished[i] = true;
+            while(nextToPrint < lines.size() && finished[nextToPrint]){
+                cout << results[nextToPrint];
+                results[nextToPrint].clear();
+                ++nextToPrint;
+            }
+            cout.flush();
+        }
+    };
+
+    if(threadCount == 0) threadCount = thread::hardware_concurrency();
+    if(threadCount == 0) threadCount = 1;
+    if(threadCount > lines.size()) threadCount = lines.size() > 0 ? lines.size() : 1;
+    vector<thread> threads;
+    for(unsigned int i = 1; i < threadCount; i++){
+        threads.push_back(thread(work));
+    }
+    work();
+    for(size_t i = 0; i < threads.size(); i++){
+        threads[i].join();
+    }
+
+    return 0;
+}
+
 /**
  * Main function to kick off the game.
  */
@@ -277,8 +714,14 @@ int main( int argc, char* argv[] ){
    string path;
 
    //~ cout << "=========<< SEARCH ALGORITHMS >>=========" << endl;
+	if(argc >= 3){
+		string typeOfRun(argv[1]);
+		std::transform(typeOfRun.begin(), typeOfRun.end(), typeOfRun.begin(), ::tolower);
+		if(typeOfRun == "batch_file") return runBatchFile(argv[2], argc >= 4 ? atoi(argv[3]) : 0, argc >= 5 ? atof(argv[4]) : 0);
+	}
 	if(argc < 5){
-		cout << "SYNTAX: main.exe <TYPE_OF_RUN = \"batch_run\" or \"single_run\"> ALGORITHM_NAME \"INITIAL STATE\" \"GOAL STATE\" " << endl;
+		cout << "SYNTAX: main.exe <TYPE_OF_RUN = \"batch_run\" or \"single_run\"> ALGORITHM_NAME \"INITIAL STATE\" \"GOAL STATE\" [TIME_LIMIT_SECONDS]" << endl;
+		cout << "    or: main.exe batch_file <FILE of \"ALGORITHM_NAME INITIAL_STATE GOAL_STATE\" lines, or - to read them from the input> [THREADS] [TIME_LIMIT_SECONDS]" << endl;
 		exit(0);
 	}
     
@@ -294,6 +737,7 @@ int main( int argc, char* argv[] ){
 	string algorithmSelected(argv[2]);
 	string initialState(argv[3]);
 	string goalState(argv[4]);
+	double timeLimit = argc >= 6 ? atof(argv[5]) : 0;
 	
     std::transform(typeOfRun.begin(), typeOfRun.end(), typeOfRun.begin(), ::tolower);
     std::transform(algorithmSelected.begin(), algorithmSelected.end(), algorithmSelected.begin(), ::tolower);
@@ -320,55 +764,15 @@ try{
 	//=========================================================================================================
 	//Run algorithm
 
-    if(algorithmSelected == "breadth_first_search" ){
-        
-        path = breadthFirstSearch(initialState, goalState, numOfStateExpansions, maxQLength, actualRunningTime);
-
-    } else if(algorithmSelected == "breadth_first_search_vlist" ){
-        
-        path = breadthFirstSearch_with_VisitedList(initialState, goalState, numOfStateExpansions, maxQLength, actualRunningTime);    
-                          
-
-    } else if(algorithmSelected == "pds_no_vlist" ){			
-		
-		path = progressiveDeepeningSearch_No_VisitedList(initialState,  goalState, numOfStateExpansions, maxQLength, actualRunningTime, 5000);		
-
-    } else if(algorithmSelected == "pds_nonstrict_vlist" ){
-        path = progressiveDeepeningSearch_with_NonStrict_VisitedList(initialState, goalState, numOfStateExpansions, maxQLength, actualRunningTime,5000);
-    	
-	
-    }  else if(algorithmSelected == "astar_explist_misplacedtiles" ){       
-        
-        path = aStar_ExpandedList(initialState, goalState, numOfStateExpansions, maxQLength, actualRunningTime, numOfDeletionsFromMiddleOfHeap,numOfLocalLoopsAvoided ,numOfAttemptedNodeReExpansions, misplacedTiles);     
-
-    }  else if(algorithmSelected == "astar_explist_manhattan" ){       
-        
-        path = aStar_ExpandedList(initialState, goalState, numOfStateExpansions, maxQLength, actualRunningTime, numOfDeletionsFromMiddleOfHeap,numOfLocalLoopsAvoided ,numOfAttemptedNodeReExpansions, manhattanDistance); 
-        
-    }
+    unique_ptr<CancellationToken> deadline(newDeadline(timeLimit));
+    path = runAlgorithm(algorithmSelected, initialState, goalState, numOfStateExpansions, maxQLength, actualRunningTime,
+                        numOfDeletionsFromMiddleOfHeap, numOfLocalLoopsAvoided, numOfAttemptedNodeReExpansions, deadline.get());
 //-----------------------------------------------------------------------------
 		
-	pathLength = path.size();
+	if(isSolution(path)) pathLength = path.size();
 		
-	//Run algorithm    
-    if(algorithmSelected == "breadth_first_search" ){
-        cout << setw(31) << std::left << "1) breadth_first_search";                    
-
-    } else if(algorithmSelected == "breadth_first_search_vlist" ){
-        cout << setw(31) << std::left << "2) breadth_first_search_vlist";             
-    
-    } else if(algorithmSelected == "pds_no_vlist" ){
-        cout << setw(31) << std::left << "3) pds_no_vlist";                  
-     
-    } else if(algorithmSelected == "pds_nonstrict_vlist" ){
-        cout << setw(31) << std::left << "4) pds_nonstrict_vlist";              
-    
-    }  else if(algorithmSelected == "astar_explist_misplacedtiles" ){
-        cout << setw(31) << std::left << "5) astar_explist_misplacedtiles";         
-        
-    }  else if(algorithmSelected == "astar_explist_manhattan" ){
-        cout << setw(31) << std::left << "6) astar_explist_manhattan";  
-    }      
+	string label = algorithmLabel(algorithmSelected);
+	if(label != "") cout << setw(31) << std::left << label;
 
 }
 
@@ -376,22 +780,10 @@ catch(exception &e){
     cout << "Standard exception: " << e.what() << endl;
 }
 
-    if(pathLength == 0) cout << "\n\n*---- NO SOLUTION found. (Q is empty!) ----*" << endl;    
-	else if(path == "OOM") cout << "\n\n*---- NO SOLUTION found. (Out of memory!) ----*" << endl;
+    printNoSolution(cout, path);
 
 	if(typeOfRun == "batch_run"){	
-		if (path == "" || path == "OOM") {
-			for (int i = 0; i < 31; ++i) {
-				cout << " ";
-			}
-		}
-		cout  << setprecision(6) << std::setfill(' ')   << std::fixed << std::right << ' ' << setw(10) << pathLength; 
-		cout  << setprecision(6) << std::setfill(' ')   << std::fixed << std::right << ' ' <<  setw(10) << numOfStateExpansions; 
-		cout  << setprecision(6) << std::setfill(' ')   << std::fixed << std::right << ' ' <<  setw(19) << maxQLength; 
-		cout  << setprecision(6) << std::setfill(' ')   << std::fixed << std::right << ' ' <<  setw(15) << actualRunningTime; 
-        cout  << setprecision(6) << std::setfill(' ')   << std::fixed << std::right << ' ' <<  setw(15) << numOfDeletionsFromMiddleOfHeap; 
-        cout  << setprecision(6) << std::setfill(' ')   << std::fixed << std::right << ' ' <<  setw(15) << numOfAttemptedNodeReExpansions << endl; 
-
+		printBatchRow(cout, path, pathLength, numOfStateExpansions, maxQLength, actualRunningTime, numOfDeletionsFromMiddleOfHeap, numOfAttemptedNodeReExpansions);
 
 	} else if(typeOfRun == "single_run"){	
 		cout << setprecision(6) << setw(25) << std::setfill(' ') <<  std::right << endl << endl << "Initial State:" << std::fixed << ' ' << setw(12) << initialState << endl;
@@ -403,11 +795,12 @@ catch(exception &e){
 
         cout << setprecision(6) << setw(25) << std::setfill(' ') <<  std::right << "Num of Deletions from MiddleOfHeap:" << std::fixed << ' ' << setprecision(6) << setw(12) <<  numOfDeletionsFromMiddleOfHeap << endl;        
         cout << setprecision(6) << setw(25) << std::setfill(' ') <<  std::right << "Num of Attempted Node ReExpansions:" << std::fixed << ' ' << setprecision(6) << setw(12) <<  numOfAttemptedNodeReExpansions << endl;
+        cout << setprecision(6) << setw(25) << std::setfill(' ') <<  std::right << "Num of Local Loops Avoided:" << std::fixed << ' ' << setprecision(6) << setw(12) <<  numOfLocalLoopsAvoided << endl;
 
 
 		cout << "================================================================================================================" << endl << endl;	
 		
-		if(path != "" && path != "OOM") {
+		if(isSolution(path)) {
 			 AnimateSolution(initialState, goalState, path);
 		}
 	}
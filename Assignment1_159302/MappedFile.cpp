@@ -0,0 +1,196 @@
+#include "MappedFile.h"
+#include <cstdio>
+#include <cstring>
+#include <utility>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+	//Table data starts on a boundary this large so it can be read with aligned loads
+	constexpr uint64_t tableDataAlignment = 64u;
+	const char tableFileMagic[8] = { 'P', 'U', 'Z', 'T', 'A', 'B', 'L', 'E' };
+}
+
+#ifdef _WIN32
+MappedFile::MappedFile(const std::string& path)
+{
+	HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE) return;
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0)
+	{
+		CloseHandle(file);
+		return;
+	}
+	HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (mapping == nullptr)
+	{
+		CloseHandle(file);
+		return;
+	}
+	void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	if (view == nullptr)
+	{
+		CloseHandle(mapping);
+		CloseHandle(file);
+		return;
+	}
+	fileHandle = file;
+	mappingHandle = mapping;
+	mData = static_cast<const unsigned char*>(view);
+	mSize = (size_t)fileSize.QuadPart;
+}
+
+void MappedFile::close() noexcept
+{
+	if (mData != nullptr)
+	{
+		UnmapViewOfFile(mData);
+		CloseHandle(mappingHandle);
+		CloseHandle(fileHandle);
+		mData = nullptr;
+		mSize = 0u;
+	}
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept : mData(other.mData), mSize(other.mSize), fileHandle(other.fileHandle),
+	mappingHandle(other.mappingHandle)
+{
+	other.mData = nullptr;
+	other.mSize = 0u;
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+	close();
+	mData = other.mData;
+	mSize = other.mSize;
+	fileHandle = other.fileHandle;
+	mappingHandle = other.mappingHandle;
+	other.mData = nullptr;
+	other.mSize = 0u;
+	return *this;
+}
+#else
+MappedFile::MappedFile(const std::string& path)
+{
+	int file = open(path.c_str(), O_RDONLY);
+	if (file == -1) return;
+	struct stat status;
+	if (fstat(file, &status) != 0 || status.st_size == 0)
+	{
+		::close(file);
+		return;
+	}
+	void* view = mmap(nullptr, (size_t)status.st_size, PROT_READ, MAP_SHARED, file, 0);
+	//The mapping stays valid after the file is closed
+	::close(file);
+	if (view == MAP_FAILED) return;
+	mData = static_cast<const unsigned char*>(view);
+	mSize = (size_t)status.st_size;
+}
+
+void MappedFile::close() noexcept
+{
+	if (mData != nullptr)
+	{
+		munmap(const_cast<unsigned char*>(mData), mSize);
+		mData = nullptr;
+		mSize = 0u;
+	}
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept : mData(other.mData), mSize(other.mSize)
+{
+	other.mData = nullptr;
+	other.mSize = 0u;
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+	close();
+	mData = other.mData;
+	mSize = other.mSize;
+	other.mData = nullptr;
+	other.mSize = 0u;
+	return *this;
+}
+#endif
+
+MappedFile::~MappedFile()
+{
+	close();
+}
+
+TableFileHeader makeTableFileHeader()
+{
+	TableFileHeader header;
+	std::memset(&header, 0, sizeof(header));
+	std::memcpy(header.magic, tableFileMagic, sizeof(header.magic));
+	header.version = tableFileVersion;
+	header.headerSize = (uint32_t)sizeof(TableFileHeader);
+	header.dataOffset = (sizeof(TableFileHeader) + tableDataAlignment - 1u) / tableDataAlignment * tableDataAlignment;
+	return header;
+}
+
+const unsigned char* findTableData(const MappedFile& file, const TableFileHeader& expected)
+{
+	if (!file.isOpen() || file.size() < sizeof(TableFileHeader)) return nullptr;
+	TableFileHeader header;
+	std::memcpy(&header, file.data(), sizeof(header));
+	if (std::memcmp(header.magic, expected.magic, sizeof(header.magic)) != 0 || header.version != expected.version ||
+		header.headerSize != expected.headerSize || header.width != expected.width || header.height != expected.height ||
+		header.bitsPerEntry != expected.bitsPerEntry || header.encoding != expected.encoding || header.patternSize != expected.patternSize ||
+		header.entryCount != expected.entryCount || header.dataSize != expected.dataSize ||
+		std::memcmp(header.goal, expected.goal, sizeof(header.goal)) != 0 ||
+		std::memcmp(header.patternTiles, expected.patternTiles, sizeof(header.patternTiles)) != 0)
+	{
+		return nullptr;
+	}
+	if (header.dataOffset % tableDataAlignment != 0u || header.dataOffset > file.size() || header.dataSize > file.size() - header.dataOffset)
+	{
+		return nullptr;
+	}
+	return file.data() + header.dataOffset;
+}
+
+bool writeTableFile(const std::string& path, const TableFileHeader& header, const unsigned char* data)
+{
+#ifdef _WIN32
+	const unsigned long processId = GetCurrentProcessId();
+#else
+	const unsigned long processId = (unsigned long)getpid();
+#endif
+	const std::string temporaryPath = path + "." + std::to_string(processId) + ".tmp";
+	std::FILE* file = std::fopen(temporaryPath.c_str(), "wb");
+	if (file == nullptr) return false;
+	const unsigned char padding[tableDataAlignment] = {};
+	bool written = std::fwrite(&header, sizeof(header), 1u, file) == 1u &&
+		std::fwrite(padding, 1u, (size_t)header.dataOffset - sizeof(header), file) == (size_t)header.dataOffset - sizeof(header) &&
+		std::fwrite(data, 1u, (size_t)header.dataSize, file) == (size_t)header.dataSize;
+	written = std::fclose(file) == 0 && written;
+	if (!written)
+	{
+		std::remove(temporaryPath.c_str());
+		return false;
+	}
+#ifdef _WIN32
+	//rename won't replace an existing file on Windows
+	if (!MoveFileExA(temporaryPath.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING))
+#else
+	if (std::rename(temporaryPath.c_str(), path.c_str()) != 0)
+#endif
+	{
+		std::remove(temporaryPath.c_str());
+		return false;
+	}
+	return true;
+}
@@ -0,0 +1,90 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/*
+* A read-only view of a whole file mapped into memory. Every process that maps the same file shares its pages.
+*/
+class MappedFile
+{
+	const unsigned char* mData = nullptr;
+	size_t mSize = 0u;
+#ifdef _WIN32
+	void* fileHandle = nullptr;
+	void* mappingHandle = nullptr;
+#endif
+
+	void close() noexcept;
+public:
+	MappedFile() noexcept {}
+
+	/*
+	* Maps the file at path. The MappedFile is left closed if the file can't be opened or is empty.
+	*/
+	explicit MappedFile(const std::string& path);
+
+	MappedFile(MappedFile&& other) noexcept;
+
+	MappedFile& operator=(MappedFile&& other) noexcept;
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	~MappedFile();
+
+	bool isOpen() const noexcept
+	{
+		return mData != nullptr;
+	}
+
+	const unsigned char* data() const noexcept
+	{
+		return mData;
+	}
+
+	size_t size() const noexcept
+	{
+		return mSize;
+	}
+};
+
+/*
+* The header at the start of every precomputed table file. Values are stored in the byte order of the machine that wrote the file.
+* version must be increased whenever the layout of the header or of any table changes.
+*/
+struct TableFileHeader
+{
+	char magic[8];
+	uint32_t version;
+	uint32_t headerSize;
+	uint32_t width;
+	uint32_t height;
+	uint32_t bitsPerEntry;
+	uint32_t encoding;
+	uint32_t patternSize;
+	uint32_t reserved;
+	uint64_t entryCount;
+	uint64_t dataOffset;
+	uint64_t dataSize;
+	unsigned char goal[32];
+	unsigned char patternTiles[32];
+};
+
+constexpr uint32_t tableFileVersion = 1u;
+
+/*
+* Fills in the fields of a header that are the same for every table.
+*/
+TableFileHeader makeTableFileHeader();
+
+/*
+* Returns the table data in file if its header describes the same table as expected, otherwise nullptr.
+*/
+const unsigned char* findTableData(const MappedFile& file, const TableFileHeader& expected);
+
+/*
+* Writes a table to a temporary file and renames it to path so other processes never see a partly written table.
+* Returns false if the table couldn't be written.
+*/
+bool writeTableFile(const std::string& path, const TableFileHeader& header, const unsigned char* data);
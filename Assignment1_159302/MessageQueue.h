@@ -0,0 +1,41 @@
+#pragma once
+#include <atomic>
+
+/*
+* A lock-free queue that any number of threads can send items to and a single thread receives from.
+* Items are linked through a pointer inside each item, found with NextItem, so sending never allocates.
+* The receiver takes every item sent so far at once, most recently sent first, which is all a search that doesn't care about the order
+* of its messages needs and means the receiver never races the senders for the same item.
+*/
+template<class T, class NextItem>
+class MessageQueue
+{
+	std::atomic<T*> head;
+public:
+	MessageQueue() noexcept : head(nullptr) {}
+
+	MessageQueue(const MessageQueue&) = delete;
+	MessageQueue& operator=(const MessageQueue&) = delete;
+
+	void send(T* item) noexcept
+	{
+		T* oldHead = head.load(std::memory_order_relaxed);
+		do
+		{
+			NextItem()(item) = oldHead;
+		} while (!head.compare_exchange_weak(oldHead, item, std::memory_order_release, std::memory_order_relaxed));
+	}
+
+	/*
+	* Returns the items sent since the last call linked through NextItem, or nullptr if there aren't any.
+	*/
+	T* receiveAll() noexcept
+	{
+		return head.exchange(nullptr, std::memory_order_acquire);
+	}
+
+	bool empty() const noexcept
+	{
+		return head.load(std::memory_order_relaxed) == nullptr;
+	}
+};
@@ -0,0 +1,291 @@
+#pragma once
+#include <limits>
+#include "Vector.h"
+#include "Deque.h"
+#include "HashMap.h"
+
+/*
+* A finite-state machine over moves of the empty tile that rejects move sequences known to reach a state that a shorter or equal length
+* sequence also reaches.
+* It is built by a breadth-first search over move sequences from every position of the empty tile. The first sequence to reach a
+* permutation is kept and every later sequence that reaches the same permutation is a duplicate. The duplicates are turned into an
+* Aho-Corasick automaton so a search only has to do one table lookup per move to know if the path it is on ends in a duplicate.
+* A path is never rejected if it is the shortest path to its state and comes first in move order among the shortest paths, so searches
+* that only skip rejected moves still find a shortest path.
+* Directions are 0 for up, 1 for right, 2 for down and 3 for left.
+*/
+template<size_t width, size_t height>
+class MovePruningAutomaton
+{
+	constexpr static size_t tileCount = width * height;
+
+	struct Permutation
+	{
+		unsigned char tiles[tileCount];
+		unsigned char emptyPos;
+
+		bool operator==(const Permutation& other) const
+		{
+			for (size_t i = 0u; i != tileCount; ++i)
+			{
+				if (tiles[i] != other.tiles[i]) return false;
+			}
+			return emptyPos == other.emptyPos;
+		}
+	};
+
+	struct PermutationHasher
+	{
+		size_t operator()(const Permutation& value) const
+		{
+			size_t result = value.emptyPos;
+			for (const auto tile : value.tiles)
+			{
+				result = result * 31u + tile;
+			}
+			return result;
+		}
+	};
+
+	struct PermutationEqualityTester
+	{
+		bool operator()(const Permutation& value1, const Permutation& value2) const
+		{
+			return value1 == value2;
+		}
+	};
+
+	struct TrieNode
+	{
+		unsigned int children[4];
+		unsigned int parent;
+		unsigned char emptyPos;
+		bool duplicate;
+	};
+
+	struct SearchNode
+	{
+		Permutation permutation;
+		unsigned int trieNode;
+		unsigned int depth;
+	};
+
+	constexpr static unsigned int none = std::numeric_limits<unsigned int>::max();
+
+	Vector<unsigned int> transitions;
+
+	static bool canMove(size_t emptyPos, size_t direction)
+	{
+		switch (direction)
+		{
+		case 0u:
+			return emptyPos / width != 0u;
+		case 1u:
+			return emptyPos % width != width - 1u;
+		case 2u:
+			return emptyPos / width != height - 1u;
+		default:
+			return emptyPos % width != 0u;
+		}
+	}
+
+	static size_t move(size_t emptyPos, size_t direction)
+	{
+		switch (direction)
+		{
+		case 0u:
+			return emptyPos - width;
+		case 1u:
+			return emptyPos + 1u;
+		case 2u:
+			return emptyPos + width;
+		default:
+			return emptyPos - 1u;
+		}
+	}
+
+	static unsigned int addTrieNode(Vector<TrieNode>& trie, unsigned int parent, size_t emptyPos, bool duplicate)
+	{
+		TrieNode node;
+		for (auto& child : node.children) child = none;
+		node.parent = parent;
+		node.emptyPos = (unsigned char)emptyPos;
+		node.duplicate = duplicate;
+		trie.push_back(node);
+		return (unsigned int)(trie.size() - 1u);
+	}
+public:
+	/*
+	* Returned by next() when the move completes a duplicate sequence.
+	*/
+	constexpr static unsigned int pruned = none;
+
+	/*
+	* Finds all duplicate sequences up to maxDepth moves long. Deeper searches find longer cycles at the cost of a larger table.
+	*/
+	explicit MovePruningAutomaton(unsigned int maxDepth)
+	{
+		//The first tileCount trie nodes are the roots for each starting position of the empty tile.
+		Vector<TrieNode> trie;
+		for (size_t emptyPos = 0u; emptyPos != tileCount; ++emptyPos)
+		{
+			addTrieNode(trie, none, emptyPos, false);
+		}
+
+		for (size_t startPos = 0u; startPos != tileCount; ++startPos)
+		{
+			HashMap<Permutation, PermutationHasher, PermutationEqualityTester> seen;
+			Deque<SearchNode> sequences;
+			SearchNode start;
+			for (size_t i = 0u; i != tileCount; ++i)
+			{
+				start.permutation.tiles[i] = (unsigned char)i;
+			}
+			start.permutation.emptyPos = (unsigned char)startPos;
+			start.trieNode = (unsigned int)startPos;
+			start.depth = 0u;
+			seen.insert(start.permutation);
+			sequences.push_back(start);
+
+			while (!sequences.empty())
+			{
+				SearchNode current = sequences.front();
+				sequences.pop_front();
+				if (current.depth == maxDepth) continue;
+				size_t emptyPos = current.permutation.emptyPos;
+				for (size_t direction = 0u; direction != 4u; ++direction)
+				{
+					if (!canMove(emptyPos, direction)) continue;
+					size_t newPos = move(emptyPos, direction);
+					SearchNode child = current;
+					child.permutation.tiles[emptyPos] = current.permutation.tiles[newPos];
+					child.permutation.tiles[newPos] = current.permutation.tiles[emptyPos];
+					child.permutation.emptyPos = (unsigned char)newPos;
+					child.depth = current.depth + 1u;
+					bool duplicate = seen.find(child.permutation) != seen.end();
+					child.trieNode = addTrieNode(trie, current.trieNode, newPos, duplicate);
+					trie[current.trieNode].children[direction] = child.trieNode;
+					if (!duplicate)
+					{
+						seen.insert(child.permutation);
+						sequences.push_back(child);
+					}
+				}
+			}
+		}
+
+		//Only prefixes of duplicate sequences need to be remembered. Children are always added after their parents.
+		Vector<bool> needed;
+		for (size_t i = 0u; i != trie.size(); ++i)
+		{
+			needed.push_back(trie[i].duplicate || i < tileCount);
+		}
+		for (size_t i = trie.size(); i != tileCount;)
+		{
+			--i;
+			if (needed[i]) needed[trie[i].parent] = true;
+		}
+		Vector<unsigned int> newIndex;
+		unsigned int nodeCount = 0u;
+		for (size_t i = 0u; i != trie.size(); ++i)
+		{
+			newIndex.push_back(needed[i] ? nodeCount++ : none);
+		}
+		Vector<TrieNode> compactTrie;
+		for (size_t i = 0u; i != trie.size(); ++i)
+		{
+			if (!needed[i]) continue;
+			TrieNode node = trie[i];
+			for (auto& child : node.children)
+			{
+				if (child != none) child = newIndex[child];
+			}
+			compactTrie.push_back(node);
+		}
+
+		//Link every sequence to its longest proper suffix that is also in the trie so a match can start at any move.
+		Vector<unsigned int> failure;
+		for (size_t i = 0u; i != nodeCount; ++i)
+		{
+			failure.push_back(none);
+			for (size_t direction = 0u; direction != 4u; ++direction)
+			{
+				transitions.push_back(none);
+			}
+		}
+		Deque<unsigned int> queue;
+		for (unsigned int root = 0u; root != tileCount; ++root)
+		{
+			for (size_t direction = 0u; direction != 4u; ++direction)
+			{
+				if (!canMove(root, direction)) continue;
+				unsigned int child = compactTrie[root].children[direction];
+				if (child != none)
+				{
+					failure[child] = (unsigned int)move(root, direction);
+					transitions[root * 4u + direction] = child;
+					queue.push_back(child);
+				}
+				else
+				{
+					transitions[root * 4u + direction] = (unsigned int)move(root, direction);
+				}
+			}
+		}
+		while (!queue.empty())
+		{
+			unsigned int current = queue.front();
+			queue.pop_front();
+			if (compactTrie[current].duplicate) continue;
+			for (size_t direction = 0u; direction != 4u; ++direction)
+			{
+				if (!canMove(compactTrie[current].emptyPos, direction)) continue;
+				unsigned int child = compactTrie[current].children[direction];
+				unsigned int fallback = transitions[failure[current] * 4u + direction];
+				if (child != none)
+				{
+					failure[child] = fallback;
+					if (fallback == pruned || compactTrie[fallback].duplicate) compactTrie[child].duplicate = true;
+					transitions[current * 4u + direction] = child;
+					queue.push_back(child);
+				}
+				else
+				{
+					transitions[current * 4u + direction] = fallback;
+				}
+			}
+		}
+
+		for (auto& transition : transitions)
+		{
+			if (transition != none && compactTrie[transition].duplicate) transition = pruned;
+		}
+	}
+
+	/*
+	* The state to start a search in when the empty tile is at emptyPos.
+	*/
+	unsigned int start(size_t emptyPos) const
+	{
+		return (unsigned int)emptyPos;
+	}
+
+	/*
+	* The state after moving the empty tile in direction or pruned if the move shouldn't be made.
+	*/
+	unsigned int next(unsigned int state, size_t direction) const
+	{
+		return transitions[state * 4u + direction];
+	}
+
+	size_t size() const
+	{
+		return transitions.size() / 4u;
+	}
+};
+
+//C++11 needs the constants defined outside the class too once they are passed by reference, as push_back does
+template<size_t width, size_t height>
+constexpr unsigned int MovePruningAutomaton<width, height>::none;
+template<size_t width, size_t height>
+constexpr unsigned int MovePruningAutomaton<width, height>::pruned;
\ No newline at end of file
@@ -0,0 +1,146 @@
+#pragma once
+#include "PriorityQueue.h"
+#include "Vector.h"
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+
+/*
+* A relaxed priority queue that any number of threads can push to and pop from at once, made of several PriorityQueues each behind its own
+* lock. push adds an item to a random heap and pop removes the better of the tops of two random heaps, so threads rarely want the same
+* lock and never wait for one: a lock that is taken just means trying other heaps.
+* pop doesn't always return the best item in the queue, only one that is close to it, which is the price of the threads not all waiting
+* for a single heap. Compare works the same as for PriorityQueue.
+*/
+template<class T, class Compare = std::less<T>>
+class MultiQueue
+{
+public:
+	using value_type = T;
+	using size_type = size_t;
+	using const_reference = const value_type&;
+private:
+	constexpr static size_t cacheLineSize = 64u;
+
+	//Each heap starts on a new cache line so threads using neighbouring heaps don't slow each other down
+	struct Heap
+	{
+		std::mutex mutex;
+		PriorityQueue<T, Vector<T>, Compare> items;
+	};
+	constexpr static size_t heapSize = (sizeof(Heap) + cacheLineSize - 1u) / cacheLineSize * cacheLineSize;
+
+	Compare comparer;
+	std::unique_ptr<char[]> storage;
+	Heap* heaps;
+	size_type heapCount;
+	std::atomic<size_type> mSize;
+
+	Heap& heapAt(size_type index)
+	{
+		return *reinterpret_cast<Heap*>(reinterpret_cast<char*>(heaps) + index * heapSize);
+	}
+
+	/*
+	* A xorshift generator for each thread so picking heaps doesn't need another shared lock.
+	*/
+	static size_type randomIndex(size_type count)
+	{
+		thread_local uint64_t state = 0u;
+		if (state == 0u) state = ((uint64_t)std::hash<std::thread::id>()(std::this_thread::get_id()) * 0x9E3779B97F4A7C15u) | 1u;
+		state ^= state << 13u;
+		state ^= state >> 7u;
+		state ^= state << 17u;
+		return (size_type)((state >> 32u) % count);
+	}
+public:
+	/*
+	* Uses heapsPerThread heaps for each of threadCount threads. Two per thread is usually enough for threads to rarely meet.
+	*/
+	explicit MultiQueue(size_type threadCount, size_type heapsPerThread = 2u) : heapCount(threadCount * heapsPerThread), mSize(0u)
+	{
+		if (heapCount < 2u) heapCount = 2u;
+		storage.reset(new char[heapCount * heapSize + cacheLineSize - 1u]);
+		const uintptr_t address = reinterpret_cast<uintptr_t>(storage.get());
+		heaps = reinterpret_cast<Heap*>((address + cacheLineSize - 1u) / cacheLineSize * cacheLineSize);
+		for (size_type i = 0u; i != heapCount; ++i)
+		{
+			new(&heapAt(i)) Heap();
+		}
+	}
+
+	MultiQueue(const MultiQueue&) = delete;
+	MultiQueue& operator=(const MultiQueue&) = delete;
+
+	~MultiQueue()
+	{
+		for (size_type i = 0u; i != heapCount; ++i)
+		{
+			heapAt(i).~Heap();
+		}
+	}
+
+	void push(const_reference value)
+	{
+		//Counted first so size is never less than the number of items in the heaps
+		mSize.fetch_add(1u, std::memory_order_relaxed);
+		while (true)
+		{
+			Heap& heap = heapAt(randomIndex(heapCount));
+			if (!heap.mutex.try_lock()) continue;
+			std::lock_guard<std::mutex> lock(heap.mutex, std::adopt_lock);
+			heap.items.push(value);
+			break;
+		}
+	}
+
+	/*
+	* Takes the better of the tops of two random heaps. Returns false without waiting if both are empty or locked by other threads, which
+	* can happen even while the rest of the heaps have items in them, so callers try again while size isn't 0.
+	*/
+	bool tryPop(value_type& value)
+	{
+		Heap& first = heapAt(randomIndex(heapCount));
+		Heap& second = heapAt(randomIndex(heapCount));
+		if (!first.mutex.try_lock()) return false;
+		std::lock_guard<std::mutex> firstLock(first.mutex, std::adopt_lock);
+		Heap* better = first.items.empty() ? nullptr : &first;
+		if (&second != &first && second.mutex.try_lock())
+		{
+			std::lock_guard<std::mutex> secondLock(second.mutex, std::adopt_lock);
+			if (!second.items.empty() && (better == nullptr || comparer(better->items.top(), second.items.top())))
+			{
+				better = &second;
+			}
+			if (better == &second)
+			{
+				value = second.items.top();
+				second.items.pop();
+				mSize.fetch_sub(1u, std::memory_order_relaxed);
+				return true;
+			}
+		}
+		if (better == nullptr) return false;
+		value = first.items.top();
+		first.items.pop();
+		mSize.fetch_sub(1u, std::memory_order_relaxed);
+		return true;
+	}
+
+	/*
+	* The number of items in the queue. It can be out of date as soon as it is returned if other threads are using the queue.
+	*/
+	size_type size() const noexcept
+	{
+		return mSize.load(std::memory_order_relaxed);
+	}
+
+	bool empty() const noexcept
+	{
+		return size() == 0u;
+	}
+};
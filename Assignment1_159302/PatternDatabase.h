@@ -0,0 +1,524 @@
+#pragma once
+#include <memory>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <utility>
+#include "Vector.h"
+#include "MappedFile.h"
+
+/*
+* Calls work on threadCount threads, including the calling thread, and waits for every call to return.
+*/
+template<class Work>
+void runOnThreads(unsigned int threadCount, Work work)
+{
+	Vector<std::thread> threads;
+	for (unsigned int i = 1u; i < threadCount; ++i)
+	{
+		threads.push_back(std::thread(work));
+	}
+	work();
+	for (auto& thread : threads)
+	{
+		thread.join();
+	}
+}
+
+/*
+* A fixed size array of small unsigned values packed bitsPerEntry bits each.
+* It either owns its memory or is a read-only view of memory owned by something else such as a MappedFile.
+*/
+template<unsigned int bitsPerEntry>
+class PackedArray
+{
+	static_assert(bitsPerEntry == 2u || bitsPerEntry == 4u, "Entries must evenly divide a byte");
+	constexpr static unsigned int entriesPerByte = 8u / bitsPerEntry;
+	constexpr static unsigned int mask = (1u << bitsPerEntry) - 1u;
+
+	std::unique_ptr<unsigned char[]> ownedData;
+	const unsigned char* mData = nullptr;
+	size_t mSize = 0u;
+public:
+	PackedArray() noexcept {}
+
+	explicit PackedArray(size_t size) : ownedData(new unsigned char[(size + entriesPerByte - 1u) / entriesPerByte]()), mData(ownedData.get()),
+		mSize(size) {}
+
+	PackedArray(const unsigned char* view, size_t size) noexcept : mData(view), mSize(size) {}
+
+	unsigned int get(size_t index) const
+	{
+		return (mData[index / entriesPerByte] >> (index % entriesPerByte * bitsPerEntry)) & mask;
+	}
+
+	/*
+	* Only arrays that own their memory can be changed.
+	*/
+	void set(size_t index, unsigned int value)
+	{
+		unsigned char& byte = ownedData[index / entriesPerByte];
+		const unsigned int shift = index % entriesPerByte * bitsPerEntry;
+		byte = (unsigned char)((byte & ~(mask << shift)) | (value << shift));
+	}
+
+	size_t size() const
+	{
+		return mSize;
+	}
+
+	size_t byteSize() const
+	{
+		return (mSize + entriesPerByte - 1u) / entriesPerByte;
+	}
+
+	const unsigned char* data() const
+	{
+		return mData;
+	}
+};
+
+/*
+* Stores each distance in four bits. Distances over 15 are stored as 15 which keeps the heuristic admissible.
+*/
+struct NibblePacking
+{
+	constexpr static unsigned int bitsPerEntry = 4u;
+	constexpr static unsigned int encoding = 0u;
+	constexpr static bool needsParentDistance = false;
+
+	static unsigned int encode(unsigned int distance)
+	{
+		return distance < 15u ? distance : 15u;
+	}
+
+	static unsigned int decode(unsigned int stored, unsigned int /*parentDistance*/)
+	{
+		return stored;
+	}
+};
+
+/*
+* Stores each distance modulo 3 in two bits. A move changes the distance by at most one so the exact distance can be recovered from the
+* distance of the state the move was made from.
+*/
+struct Mod3Packing
+{
+	constexpr static unsigned int bitsPerEntry = 2u;
+	constexpr static unsigned int encoding = 1u;
+	constexpr static bool needsParentDistance = true;
+
+	static unsigned int encode(unsigned int distance)
+	{
+		return distance % 3u;
+	}
+
+	static unsigned int decode(unsigned int stored, unsigned int parentDistance)
+	{
+		const unsigned int parentStored = parentDistance % 3u;
+		if (stored == parentStored) return parentDistance;
+		if (stored == (parentStored + 1u) % 3u) return parentDistance + 1u;
+		return parentDistance - 1u;
+	}
+};
+
+/*
+* What a PatternDatabase is built with when nothing can stop the build.
+*/
+struct NeverStop
+{
+	bool operator()() const
+	{
+		return false;
+	}
+};
+
+/*
+* The number of moves needed to put a subset of the tiles, always including the empty tile, into their goal positions while ignoring
+* every other tile. The positions of the pattern tiles are ranked as a partial permutation so the table has exactly
+* tileCount! / (tileCount - patternSize)! entries with no gaps.
+* A database can be saved to a table file and mapped back in by later processes instead of being built again.
+*/
+template<size_t width, size_t height, class Packing>
+class PatternDatabase
+{
+	constexpr static size_t tileCount = width * height;
+	constexpr static unsigned char notInPattern = std::numeric_limits<unsigned char>::max();
+	static_assert(tileCount <= sizeof(TableFileHeader::goal), "The goal must fit in a table file header");
+
+	unsigned char patternIndices[tileCount];
+	unsigned char goalPositions[tileCount];
+	unsigned char goalPositionsOfTiles[tileCount];
+	size_t patternSize;
+	PackedArray<Packing::bitsPerEntry> entries;
+	MappedFile file;
+	TableFileHeader header;
+
+	static size_t entryCount(size_t patternSize)
+	{
+		size_t count = 1u;
+		for (size_t i = 0u; i != patternSize; ++i)
+		{
+			count *= tileCount - i;
+		}
+		return count;
+	}
+
+	bool isGoal(const unsigned char* positions) const
+	{
+		for (size_t i = 0u; i != patternSize; ++i)
+		{
+			if (positions[i] != goalPositions[i]) return false;
+		}
+		return true;
+	}
+
+	/*
+	* Moves the empty tile, which is pattern tile 0, to newPos swapping it with whichever pattern tile is there.
+	*/
+	void moveEmptyTile(unsigned char* positions, size_t newPos) const
+	{
+		for (size_t i = 1u; i != patternSize; ++i)
+		{
+			if (positions[i] == newPos)
+			{
+				positions[i] = positions[0];
+				break;
+			}
+		}
+		positions[0] = (unsigned char)newPos;
+	}
+
+	template<class Goal>
+	void setPattern(const Goal& goal, const unsigned char* tiles, size_t tileListSize)
+	{
+		patternSize = tileListSize + 1u;
+		for (auto& index : patternIndices) index = notInPattern;
+		patternIndices[0] = 0u;
+		for (size_t i = 0u; i != tileListSize; ++i)
+		{
+			patternIndices[tiles[i]] = (unsigned char)(i + 1u);
+		}
+		for (size_t pos = 0u; pos != tileCount; ++pos)
+		{
+			goalPositionsOfTiles[(size_t)goal.tiles[pos]] = (unsigned char)pos;
+			const unsigned char index = patternIndices[(size_t)goal.tiles[pos]];
+			if (index != notInPattern) goalPositions[index] = (unsigned char)pos;
+		}
+
+		header = makeTableFileHeader();
+		header.width = (uint32_t)width;
+		header.height = (uint32_t)height;
+		header.bitsPerEntry = Packing::bitsPerEntry;
+		header.encoding = Packing::encoding;
+		header.patternSize = (uint32_t)patternSize;
+		header.entryCount = entryCount(patternSize);
+		header.dataSize = PackedArray<Packing::bitsPerEntry>(nullptr, entryCount(patternSize)).byteSize();
+		for (size_t pos = 0u; pos != tileCount; ++pos)
+		{
+			header.goal[pos] = (unsigned char)goal.tiles[pos];
+		}
+		header.patternTiles[0] = 0u;
+		for (size_t i = 0u; i != tileListSize; ++i)
+		{
+			header.patternTiles[i + 1u] = tiles[i];
+		}
+	}
+
+	/*
+	* Fills the database with a level-synchronous breadth-first search back from the goal using threadCount threads.
+	* Each level the threads take chunks of the ranks in the frontier, a bitset, and claim children in the visited bitset with an
+	* atomic or, so each entry is written by exactly one thread and only the level number has to be shared.
+	* The threads ask shouldStop before each chunk. If it returns true the database is left empty and false is returned.
+	*/
+	template<class ShouldStop>
+	bool build(unsigned int threadCount, ShouldStop shouldStop)
+	{
+		using Word = std::atomic<uint64_t>;
+		constexpr size_t bitsPerWord = 64u;
+		constexpr size_t entriesPerWord = bitsPerWord / Packing::bitsPerEntry;
+		constexpr size_t wordsPerChunk = 1024u;
+
+		const size_t count = entryCount(patternSize);
+		const size_t wordCount = (count + bitsPerWord - 1u) / bitsPerWord;
+		std::unique_ptr<Word[]> visited(new Word[wordCount]());
+		std::unique_ptr<Word[]> frontier(new Word[wordCount]());
+		std::unique_ptr<Word[]> next(new Word[wordCount]());
+		std::unique_ptr<Word[]> values(new Word[(count + entriesPerWord - 1u) / entriesPerWord]());
+
+		const size_t goalRank = rank(goalPositions);
+		visited[goalRank / bitsPerWord].store(uint64_t(1u) << goalRank % bitsPerWord, std::memory_order_relaxed);
+		frontier[goalRank / bitsPerWord].store(uint64_t(1u) << goalRank % bitsPerWord, std::memory_order_relaxed);
+		values[goalRank / entriesPerWord].store(uint64_t(Packing::encode(0u)) << goalRank % entriesPerWord * Packing::bitsPerEntry,
+			std::memory_order_relaxed);
+
+		for (unsigned int distance = 0u;; ++distance)
+		{
+			std::atomic<size_t> nextChunk(0u);
+			std::atomic<bool> foundChild(false);
+			std::atomic<bool> stopped(false);
+			const uint64_t childValue = Packing::encode(distance + 1u);
+			runOnThreads(threadCount, [&]()
+			{
+				bool found = false;
+				for (size_t first = nextChunk.fetch_add(wordsPerChunk, std::memory_order_relaxed); first < wordCount;
+					first = nextChunk.fetch_add(wordsPerChunk, std::memory_order_relaxed))
+				{
+					if (shouldStop())
+					{
+						stopped.store(true, std::memory_order_relaxed);
+						break;
+					}
+					const size_t last = first + wordsPerChunk < wordCount ? first + wordsPerChunk : wordCount;
+					for (size_t word = first; word != last; ++word)
+					{
+						uint64_t bits = frontier[word].exchange(0u, std::memory_order_relaxed);
+						for (; bits != 0u; bits &= bits - 1u)
+						{
+							size_t bit = 0u;
+							while ((bits >> bit & 1u) == 0u) ++bit;
+							unsigned char positions[tileCount];
+							unrank(word * bitsPerWord + bit, positions);
+							const size_t emptyPos = positions[0];
+							const size_t newPositions[4] = { emptyPos - width, emptyPos + 1u, emptyPos + width, emptyPos - 1u };
+							const bool canMove[4] = { emptyPos / width != 0u, emptyPos % width != width - 1u, emptyPos / width != height - 1u, emptyPos % width != 0u };
+							for (size_t direction = 0u; direction != 4u; ++direction)
+							{
+								if (!canMove[direction]) continue;
+								unsigned char childPositions[tileCount];
+								std::memcpy(childPositions, positions, patternSize);
+								moveEmptyTile(childPositions, newPositions[direction]);
+								const size_t child = rank(childPositions);
+								const uint64_t childBit = uint64_t(1u) << child % bitsPerWord;
+								if ((visited[child / bitsPerWord].fetch_or(childBit, std::memory_order_relaxed) & childBit) != 0u) continue;
+								next[child / bitsPerWord].fetch_or(childBit, std::memory_order_relaxed);
+								values[child / entriesPerWord].fetch_or(childValue << child % entriesPerWord * Packing::bitsPerEntry,
+									std::memory_order_relaxed);
+								found = true;
+							}
+						}
+					}
+				}
+				if (found) foundChild.store(true, std::memory_order_relaxed);
+			});
+			if (stopped.load(std::memory_order_relaxed)) return false;
+			if (!foundChild.load(std::memory_order_relaxed)) break;
+			std::swap(frontier, next);
+		}
+
+		entries = PackedArray<Packing::bitsPerEntry>(count);
+		constexpr uint64_t mask = (uint64_t(1u) << Packing::bitsPerEntry) - 1u;
+		for (size_t i = 0u; i != count; ++i)
+		{
+			const uint64_t word = values[i / entriesPerWord].load(std::memory_order_relaxed);
+			entries.set(i, (unsigned int)(word >> i % entriesPerWord * Packing::bitsPerEntry & mask));
+		}
+		return true;
+	}
+public:
+	/*
+	* Builds the database. tiles lists the pattern tiles other than the empty tile.
+	*/
+	template<class Goal>
+	PatternDatabase(const Goal& goal, const unsigned char* tiles, size_t tileListSize, unsigned int threadCount = 1u)
+	{
+		setPattern(goal, tiles, tileListSize);
+		build(threadCount, NeverStop());
+	}
+
+	/*
+	* Maps the database from the table file at path if the file holds this database. Otherwise builds it and tries to save it to path
+	* for the next process, unless path is empty.
+	* If shouldStop returns true before the build is done the database is left empty, with a size of 0, and isn't saved.
+	*/
+	template<class Goal, class ShouldStop = NeverStop>
+	PatternDatabase(const Goal& goal, const unsigned char* tiles, size_t tileListSize, const std::string& path,
+		ShouldStop shouldStop = ShouldStop()) : file(path)
+	{
+		setPattern(goal, tiles, tileListSize);
+		const unsigned char* data = findTableData(file, header);
+		if (data != nullptr)
+		{
+			entries = PackedArray<Packing::bitsPerEntry>(data, entryCount(patternSize));
+		}
+		else
+		{
+			file = MappedFile();
+			if (build(1u, shouldStop) && !path.empty()) save(path);
+		}
+	}
+
+	bool save(const std::string& path) const
+	{
+		return writeTableFile(path, header, entries.data());
+	}
+
+	/*
+	* True if the database was mapped from a table file instead of being built.
+	*/
+	bool isMapped() const
+	{
+		return file.isOpen();
+	}
+
+	size_t size() const
+	{
+		return entries.size();
+	}
+
+	size_t byteSize() const
+	{
+		return entries.byteSize();
+	}
+
+	/*
+	* Ranks the positions of the pattern tiles. Each position is numbered among the cells not used by earlier pattern tiles.
+	*/
+	size_t rank(const unsigned char* positions) const
+	{
+		size_t result = 0u;
+		for (size_t i = 0u; i != patternSize; ++i)
+		{
+			size_t earlierAndSmaller = 0u;
+			for (size_t j = 0u; j != i; ++j)
+			{
+				if (positions[j] < positions[i]) ++earlierAndSmaller;
+			}
+			result = result * (tileCount - i) + (positions[i] - earlierAndSmaller);
+		}
+		return result;
+	}
+
+	void unrank(size_t rank, unsigned char* positions) const
+	{
+		size_t digits[tileCount];
+		for (size_t i = patternSize; i != 0u;)
+		{
+			--i;
+			digits[i] = rank % (tileCount - i);
+			rank /= tileCount - i;
+		}
+		bool used[tileCount] = {};
+		for (size_t i = 0u; i != patternSize; ++i)
+		{
+			size_t pos = 0u;
+			for (size_t unusedBefore = digits[i];; ++pos)
+			{
+				if (used[pos]) continue;
+				if (unusedBefore == 0u) break;
+				--unusedBefore;
+			}
+			used[pos] = true;
+			positions[i] = (unsigned char)pos;
+		}
+	}
+
+	template<class Map>
+	void positionsOf(const Map& state, unsigned char* positions) const
+	{
+		for (size_t pos = 0u; pos != tileCount; ++pos)
+		{
+			const unsigned char index = patternIndices[(size_t)state.tiles[pos]];
+			if (index != notInPattern) positions[index] = (unsigned char)pos;
+		}
+	}
+
+	/*
+	* The distance of a state one move away from a state with distance parentDistance.
+	*/
+	template<class Map>
+	unsigned int distance(const Map& state, unsigned int parentDistance) const
+	{
+		unsigned char positions[tileCount];
+		positionsOf(state, positions);
+		return Packing::decode(entries.get(rank(positions)), parentDistance);
+	}
+
+	/*
+	* The distance of a state without knowing the distance of a neighbour. If only part of each distance is stored, this follows stored
+	* values down to the goal counting the moves.
+	*/
+	template<class Map>
+	unsigned int distance(const Map& state) const
+	{
+		unsigned char positions[tileCount];
+		positionsOf(state, positions);
+		return distanceOfPositions(positions);
+	}
+
+	/*
+	* The distance of the dual of a state, the state with the roles of tiles and positions swapped. The tile that belongs in each goal
+	* position of a pattern tile stands in for that pattern tile so no table has to be built for the dual.
+	* Only states with the empty tile in its goal position have a dual that is the same number of moves from the goal.
+	*/
+	template<class Map>
+	unsigned int dualDistance(const Map& state) const
+	{
+		unsigned char positions[tileCount];
+		for (size_t i = 0u; i != patternSize; ++i)
+		{
+			positions[i] = goalPositionsOfTiles[(size_t)state.tiles[goalPositions[i]]];
+		}
+		return distanceOfPositions(positions);
+	}
+
+	/*
+	* The distance of the pattern tiles at positions. positions is used as scratch space.
+	*/
+	unsigned int distanceOfPositions(unsigned char* positions) const
+	{
+		unsigned int stored = entries.get(rank(positions));
+		if (!Packing::needsParentDistance) return stored;
+
+		unsigned int distance = 0u;
+		bool found = true;
+		while (found && !isGoal(positions))
+		{
+			found = false;
+			const size_t emptyPos = positions[0];
+			const size_t newPositions[4] = { emptyPos - width, emptyPos + 1u, emptyPos + width, emptyPos - 1u };
+			const bool canMove[4] = { emptyPos / width != 0u, emptyPos % width != width - 1u, emptyPos / width != height - 1u, emptyPos % width != 0u };
+			for (size_t direction = 0u; direction != 4u; ++direction)
+			{
+				if (!canMove[direction]) continue;
+				unsigned char childPositions[tileCount];
+				std::memcpy(childPositions, positions, patternSize);
+				moveEmptyTile(childPositions, newPositions[direction]);
+				const unsigned int childStored = entries.get(rank(childPositions));
+				//Any neighbour that is one move closer to the goal will do
+				if (Packing::decode(childStored, 3u + stored) == 2u + stored)
+				{
+					std::memcpy(positions, childPositions, patternSize);
+					stored = childStored;
+					++distance;
+					found = true;
+					break;
+				}
+			}
+		}
+		return distance;
+	}
+};
+
+/*
+* The table file a pattern database is kept in inside directory, named after the board, the goal and the pattern tiles.
+*/
+template<size_t width, size_t height, class Goal>
+std::string patternDatabasePath(const std::string& directory, const Goal& goal, const unsigned char* tiles, size_t tileListSize)
+{
+	constexpr char digits[] = "0123456789abcdefghijklmnopqrstuvwxyz";
+	std::string path = directory + "/pdb_" + std::to_string(width) + "x" + std::to_string(height) + "_";
+	for (size_t pos = 0u; pos != width * height; ++pos)
+	{
+		path += digits[(size_t)goal.tiles[pos] % 36u];
+	}
+	path += "_";
+	for (size_t i = 0u; i != tileListSize; ++i)
+	{
+		path += digits[tiles[i] % 36u];
+	}
+	return path + ".tbl";
+}
\ No newline at end of file
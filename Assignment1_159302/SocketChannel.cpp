@@ -0,0 +1,112 @@
+#include "SocketChannel.h"
+
+#ifdef HAS_WORKER_PROCESSES
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <memory>
+
+namespace
+{
+	constexpr size_t readSize = 64u * 1024u;
+}
+
+SocketChannel::SocketChannel(int descriptor) : descriptor(descriptor)
+{
+	fcntl(descriptor, F_SETFL, fcntl(descriptor, F_GETFL) | O_NONBLOCK);
+}
+
+SocketChannel::~SocketChannel()
+{
+	if (descriptor != -1) ::close(descriptor);
+}
+
+bool SocketChannel::flush()
+{
+	size_t written = 0u;
+	while (written != outgoing.size())
+	{
+		//MSG_NOSIGNAL so a process that has exited shows up as an error instead of killing the sender with SIGPIPE
+		const ssize_t result = ::send(descriptor, outgoing.data() + written, outgoing.size() - written, MSG_NOSIGNAL);
+		if (result < 0)
+		{
+			if (errno == EINTR) continue;
+			if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+			return false;
+		}
+		written += (size_t)result;
+	}
+	outgoing.erase(0u, written);
+	return true;
+}
+
+bool SocketChannel::receive()
+{
+	//Messages already taken are only dropped from the buffer when reading more so next doesn't move the buffer every time
+	incoming.erase(0u, incomingStart);
+	incomingStart = 0u;
+	while (true)
+	{
+		const size_t oldSize = incoming.size();
+		incoming.resize(oldSize + readSize);
+		const ssize_t result = ::recv(descriptor, &incoming[oldSize], readSize, 0);
+		incoming.resize(oldSize + (result > 0 ? (size_t)result : 0u));
+		if (result > 0) continue;
+		if (result == 0) return false;
+		if (errno == EINTR) continue;
+		return errno == EAGAIN || errno == EWOULDBLOCK;
+	}
+}
+
+bool SocketChannel::next(ChannelMessage& message)
+{
+	if (incoming.size() - incomingStart < sizeof(ChannelMessage)) return false;
+	std::memcpy(&message, incoming.data() + incomingStart, sizeof(ChannelMessage));
+	incomingStart += sizeof(ChannelMessage);
+	return true;
+}
+
+bool createSocketPair(int descriptors[2])
+{
+	return socketpair(AF_UNIX, SOCK_STREAM, 0, descriptors) == 0;
+}
+
+void closeDescriptor(int descriptor)
+{
+	::close(descriptor);
+}
+
+void waitForChannels(SocketChannel* const* channels, size_t count, int timeoutMilliseconds)
+{
+	std::unique_ptr<pollfd[]> descriptors(new pollfd[count]);
+	for (size_t i = 0u; i != count; ++i)
+	{
+		descriptors[i].fd = channels[i]->fileDescriptor();
+		descriptors[i].events = (short)(POLLIN | (channels[i]->unsentBytes() != 0u ? POLLOUT : 0));
+		descriptors[i].revents = 0;
+	}
+	poll(descriptors.get(), (nfds_t)count, timeoutMilliseconds);
+}
+
+long startWorkerProcess()
+{
+	return (long)fork();
+}
+
+void exitWorkerProcess()
+{
+	_exit(0);
+}
+
+void waitForWorkerProcess(long processId)
+{
+	int status;
+	while (waitpid((pid_t)processId, &status, 0) == -1 && errno == EINTR)
+	{
+	}
+}
+#endif
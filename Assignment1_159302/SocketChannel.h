@@ -0,0 +1,99 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+//Worker processes are started with fork so distributed searches are only available on POSIX systems
+#ifndef _WIN32
+#define HAS_WORKER_PROCESSES
+
+/*
+* The fixed size record processes of a distributed search exchange. What the fields mean depends on type.
+*/
+struct ChannelMessage
+{
+	uint32_t type;
+	uint32_t value;
+	uint64_t state;
+	uint64_t first;
+	uint64_t second;
+};
+
+/*
+* One end of a connected UNIX domain stream socket. Messages sent are buffered and only written by flush so they go out in batches,
+* and neither writing nor reading ever blocks, so two processes sending to each other can't deadlock on full socket buffers.
+*/
+class SocketChannel
+{
+	int descriptor = -1;
+	std::string incoming;
+	std::string outgoing;
+	size_t incomingStart = 0u;
+public:
+	SocketChannel() noexcept {}
+
+	/*
+	* Takes ownership of one end of a socket pair.
+	*/
+	explicit SocketChannel(int descriptor);
+
+	SocketChannel(const SocketChannel&) = delete;
+	SocketChannel& operator=(const SocketChannel&) = delete;
+
+	~SocketChannel();
+
+	void send(const ChannelMessage& message)
+	{
+		outgoing.append(reinterpret_cast<const char*>(&message), sizeof(message));
+	}
+
+	/*
+	* Writes as much of the buffered messages as the socket will take. Returns false if the other end has gone.
+	*/
+	bool flush();
+
+	/*
+	* Reads everything that has arrived so far. Returns false if the other end has gone.
+	*/
+	bool receive();
+
+	/*
+	* Takes the oldest complete message that has been received. Returns false if there isn't one.
+	*/
+	bool next(ChannelMessage& message);
+
+	size_t unsentBytes() const noexcept
+	{
+		return outgoing.size();
+	}
+
+	int fileDescriptor() const noexcept
+	{
+		return descriptor;
+	}
+};
+
+/*
+* Creates a connected pair of sockets for two processes to talk through. Returns false if it can't.
+*/
+bool createSocketPair(int descriptors[2]);
+
+void closeDescriptor(int descriptor);
+
+/*
+* Waits until one of the channels has something to read or can write more of its buffered messages, or timeoutMilliseconds have passed.
+*/
+void waitForChannels(SocketChannel* const* channels, size_t count, int timeoutMilliseconds);
+
+/*
+* Starts a copy of this process. Returns 0 in the copy, the copy's id in this process and -1 if it couldn't be started.
+*/
+long startWorkerProcess();
+
+/*
+* Ends a worker process without running destructors or flushing output buffers it shares with the process that started it.
+*/
+[[noreturn]] void exitWorkerProcess();
+
+void waitForWorkerProcess(long processId);
+#endif
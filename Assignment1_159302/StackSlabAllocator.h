@@ -1,5 +1,78 @@
 #pragma once
 #include <memory>
+#include <new>
+
+/*
+* Allocates single blocks for StackSlabAllocator. Each thread keeps up to maxCachedBytes of the blocks it frees and hands them out again
+* before asking std::allocator, so a thread solving one puzzle after another reuses memory it has already touched instead of starting
+* cold. The cached blocks are freed when the thread exits.
+*/
+template<class T, size_t maxCachedBytes = 32u * 1024u * 1024u>
+class ThreadCachedAllocator : std::allocator<T>
+{
+	struct FreeBlock
+	{
+		FreeBlock* next;
+	};
+	static_assert(sizeof(T) >= sizeof(FreeBlock) && alignof(T) >= alignof(FreeBlock), "A free block must fit in a block");
+
+	constexpr static size_t maxCachedBlocks = maxCachedBytes / sizeof(T) != 0u ? maxCachedBytes / sizeof(T) : 1u;
+
+	struct Cache
+	{
+		FreeBlock* head = nullptr;
+		size_t count = 0u;
+
+		~Cache()
+		{
+			while (head != nullptr)
+			{
+				FreeBlock* next = head->next;
+				std::allocator<T>().deallocate(reinterpret_cast<T*>(head), 1u);
+				head = next;
+			}
+		}
+	};
+
+	static Cache& cache()
+	{
+		thread_local Cache threadCache;
+		return threadCache;
+	}
+public:
+	using value_type = T;
+
+	T* allocate(size_t count)
+	{
+		if (count == 1u)
+		{
+			Cache& threadCache = cache();
+			if (threadCache.head != nullptr)
+			{
+				FreeBlock* block = threadCache.head;
+				threadCache.head = block->next;
+				--threadCache.count;
+				return reinterpret_cast<T*>(block);
+			}
+		}
+		return std::allocator<T>::allocate(count);
+	}
+
+	void deallocate(T* pointer, size_t count)
+	{
+		if (count == 1u)
+		{
+			Cache& threadCache = cache();
+			if (threadCache.count != maxCachedBlocks)
+			{
+				threadCache.head = new(pointer) FreeBlock{ threadCache.head };
+				++threadCache.count;
+				return;
+			}
+		}
+		std::allocator<T>::deallocate(pointer, count);
+	}
+};
 
 /*
 * Allocates and Deallocates memory in fifi order.
@@ -15,7 +88,7 @@ struct StackSlabAllocatorNode
 };
 
 template<size_t element_size, size_t element_align, size_t block_size_in_elements,
-	class Allocator = std::allocator<StackSlabAllocatorNode<element_size, element_align, block_size_in_elements>>>
+	class Allocator = ThreadCachedAllocator<StackSlabAllocatorNode<element_size, element_align, block_size_in_elements>>>
 class StackSlabAllocator : Allocator
 {
 	StackSlabAllocatorNode<element_size, element_align, block_size_in_elements>* mData;
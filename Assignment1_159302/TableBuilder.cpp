@@ -0,0 +1,135 @@
+//////////////////////////////////////////////////////////////////////////
+//  TABLE BUILDER
+//
+//  Builds pattern databases ahead of time and saves them as table files
+//  that the solver maps in when PUZZLE_TABLE_DIR points at the same
+//  directory. A pattern holding every tile is the full distance table.
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include "PatternDatabase.h"
+
+using namespace std;
+
+/*
+* The goal layout. Tiles are written with one character each, 0 to 9 then a to z, and 0 is the empty tile.
+*/
+template<size_t width, size_t height>
+struct TableGoal
+{
+	unsigned char tiles[width * height];
+};
+
+static int tileValue(char character)
+{
+	if (character >= '0' && character <= '9') return character - '0';
+	if (character >= 'a' && character <= 'z') return character - 'a' + 10;
+	if (character >= 'A' && character <= 'Z') return character - 'A' + 10;
+	return -1;
+}
+
+template<size_t width, size_t height>
+static int buildTables(const string& directory, const string& goalState, char** patterns, int patternCount, unsigned int threadCount)
+{
+	constexpr size_t tileCount = width * height;
+	TableGoal<width, height> goal;
+	bool seen[tileCount] = {};
+	if (goalState.size() != tileCount)
+	{
+		cout << "The goal state must have " << tileCount << " tiles." << endl;
+		return 1;
+	}
+	for (size_t pos = 0u; pos != tileCount; ++pos)
+	{
+		const int tile = tileValue(goalState[pos]);
+		if (tile < 0 || (size_t)tile >= tileCount || seen[tile])
+		{
+			cout << "The goal state must hold every tile from 0 to " << tileCount - 1u << " once." << endl;
+			return 1;
+		}
+		seen[tile] = true;
+		goal.tiles[pos] = (unsigned char)tile;
+	}
+
+	for (int i = 0; i != patternCount; ++i)
+	{
+		const string pattern(patterns[i]);
+		unsigned char tiles[tileCount];
+		bool inPattern[tileCount] = {};
+		if (pattern.empty() || pattern.size() >= tileCount)
+		{
+			cout << "Pattern \"" << pattern << "\" must have between 1 and " << tileCount - 1u << " tiles." << endl;
+			return 1;
+		}
+		for (size_t j = 0u; j != pattern.size(); ++j)
+		{
+			const int tile = tileValue(pattern[j]);
+			if (tile <= 0 || (size_t)tile >= tileCount || inPattern[tile])
+			{
+				cout << "Pattern \"" << pattern << "\" must list tiles from 1 to " << tileCount - 1u << " at most once." << endl;
+				return 1;
+			}
+			inPattern[tile] = true;
+			tiles[j] = (unsigned char)tile;
+		}
+
+		const string path = patternDatabasePath<width, height>(directory, goal, tiles, pattern.size());
+		const auto startTime = chrono::steady_clock::now();
+		try
+		{
+			PatternDatabase<width, height, Mod3Packing> database(goal, tiles, pattern.size(), threadCount);
+			const double seconds = chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+			if (!database.save(path))
+			{
+				cout << "Couldn't write " << path << endl;
+				return 1;
+			}
+			cout << path << ": " << database.size() << " entries, " << database.byteSize() << " bytes, built in " << seconds << " seconds" << endl;
+		}
+		catch (bad_alloc&)
+		{
+			cout << "Not enough memory for pattern \"" << pattern << "\"." << endl;
+			return 1;
+		}
+	}
+	return 0;
+}
+
+int main(int argc, char* argv[])
+{
+	if (argc < 5)
+	{
+		cout << "SYNTAX: TableBuilder.exe OUTPUT_DIRECTORY <WIDTH>x<HEIGHT> \"GOAL STATE\" PATTERN_TILES [PATTERN_TILES ...] [--threads N]" << endl;
+		cout << "e.g.    TableBuilder.exe tables 3x3 \"123804765\" 1238 4765" << endl;
+		exit(0);
+	}
+
+	const string directory(argv[1]);
+	const string size(argv[2]);
+	const string goalState(argv[3]);
+	unsigned int threadCount = thread::hardware_concurrency();
+	int patternCount = argc - 4;
+	if (patternCount >= 2 && strcmp(argv[argc - 2], "--threads") == 0)
+	{
+		threadCount = (unsigned int)atoi(argv[argc - 1]);
+		patternCount -= 2;
+	}
+	if (threadCount == 0u) threadCount = 1u;
+	if (patternCount == 0)
+	{
+		cout << "No pattern tiles given." << endl;
+		return 1;
+	}
+
+	if (size == "3x3") return buildTables<3u, 3u>(directory, goalState, argv + 4, patternCount, threadCount);
+	if (size == "4x4") return buildTables<4u, 4u>(directory, goalState, argv + 4, patternCount, threadCount);
+	cout << "Only 3x3 and 4x4 boards are supported." << endl;
+	return 1;
+}
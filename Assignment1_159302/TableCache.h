@@ -0,0 +1,138 @@
+#pragma once
+#include <chrono>
+#include <exception>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+/*
+* Keeps the capacity most recently used tables, each found by the Key it was built for. The cache only shares ownership of its tables,
+* so a table dropped to make room for a newer one is freed as soon as the last search holding it lets go.
+* The first thread to ask for a table builds it without holding the lock and any other thread asking for the same table waits for it,
+* so threads using tables that are already built are never held up by a build.
+*/
+template<class Key, class Table, size_t capacity>
+class TableCache
+{
+	struct Slot
+	{
+		Key key;
+		std::shared_future<std::shared_ptr<const Table>> table;
+		unsigned long long build;
+	};
+
+	std::mutex mutex;
+	//Most recently used first
+	Slot slots[capacity];
+	size_t used = 0u;
+	unsigned long long builds = 0u;
+
+	/*
+	* Returns the index of the slot for key or used if there isn't one. The lock must be held.
+	*/
+	size_t indexOf(const Key& key) const
+	{
+		size_t i = 0u;
+		while (i != used && !(slots[i].key == key)) ++i;
+		return i;
+	}
+
+	/*
+	* Moves a slot to the front as the most recently used. The lock must be held.
+	*/
+	void moveToFront(size_t index)
+	{
+		Slot slot = std::move(slots[index]);
+		for (size_t i = index; i != 0u; --i) slots[i] = std::move(slots[i - 1u]);
+		slots[0] = std::move(slot);
+	}
+
+	/*
+	* Forgets a build that failed so the next thread to ask for the table tries again. The lock must be held.
+	*/
+	void remove(unsigned long long build)
+	{
+		size_t i = 0u;
+		while (i != used && slots[i].build != build) ++i;
+		if (i == used) return;
+		for (--used; i != used; ++i) slots[i] = std::move(slots[i + 1u]);
+		slots[used] = Slot();
+	}
+public:
+	TableCache() = default;
+	TableCache(const TableCache&) = delete;
+	TableCache& operator=(const TableCache&) = delete;
+
+	/*
+	* Returns the table for key if it has been built and is still cached, otherwise null.
+	*/
+	std::shared_ptr<const Table> find(const Key& key)
+	{
+		std::shared_future<std::shared_ptr<const Table>> table;
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			const size_t index = indexOf(key);
+			if (index == used) return nullptr;
+			moveToFront(index);
+			table = slots[0].table;
+		}
+		if (table.wait_for(std::chrono::seconds(0)) != std::future_status::ready) return nullptr;
+		try
+		{
+			return table.get();
+		}
+		catch (...)
+		{
+			return nullptr;
+		}
+	}
+
+	/*
+	* Returns the table for key, calling build to make it if it isn't cached. Anything build throws is thrown to every thread waiting for it.
+	*/
+	template<class Build>
+	std::shared_ptr<const Table> get(const Key& key, Build build)
+	{
+		std::promise<std::shared_ptr<const Table>> promise;
+		std::shared_future<std::shared_ptr<const Table>> table;
+		unsigned long long thisBuild = 0u;
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			const size_t index = indexOf(key);
+			if (index != used)
+			{
+				moveToFront(index);
+				table = slots[0].table;
+			}
+			else
+			{
+				//The least recently used table is dropped but searches still holding it keep it alive
+				if (used == capacity) --used;
+				thisBuild = ++builds;
+				slots[used].key = key;
+				slots[used].table = promise.get_future().share();
+				slots[used].build = thisBuild;
+				moveToFront(used);
+				++used;
+			}
+		}
+		if (table.valid()) return table.get();
+
+		try
+		{
+			std::shared_ptr<const Table> built(build());
+			promise.set_value(built);
+			return built;
+		}
+		catch (...)
+		{
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				remove(thisBuild);
+			}
+			promise.set_exception(std::current_exception());
+			throw;
+		}
+	}
+};
\ No newline at end of file
@@ -0,0 +1,153 @@
+#pragma once
+#include "Vector.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+
+/*
+* The blocks shared by the ThreadSlabAllocators of a search. Blocks are block_size bytes and aligned to block_size, which must be a power of
+* two, so the block an element is in can be found from the element's address. A block whose elements have all been released goes back to the
+* pool for any thread to use, which is how memory moves between threads when the nodes in it are sent to another thread and freed there.
+* Every block is freed when the pool is destructed, so the pool must outlive everything allocated from it.
+*/
+template<size_t block_size>
+class SlabBlockPool
+{
+	static_assert((block_size & (block_size - 1u)) == 0u, "block_size must be a power of two");
+	constexpr static size_t blocksPerChunk = 16u;
+
+	std::mutex mutex;
+	Vector<void*> freeBlocks;
+	Vector<char*> chunks;
+public:
+	SlabBlockPool() {}
+
+	SlabBlockPool(const SlabBlockPool&) = delete;
+	SlabBlockPool& operator=(const SlabBlockPool&) = delete;
+
+	~SlabBlockPool()
+	{
+		for (size_t i = 0u; i != chunks.size(); ++i)
+		{
+			delete[] chunks[i];
+		}
+	}
+
+	void* acquire()
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		if (freeBlocks.empty())
+		{
+			//Blocks are taken from the system a chunk at a time, with a block to spare so they can be aligned to their size
+			std::unique_ptr<char[]> chunk(new char[(blocksPerChunk + 1u) * block_size]);
+			const uintptr_t address = reinterpret_cast<uintptr_t>(chunk.get());
+			char* const firstBlock = reinterpret_cast<char*>((address + block_size - 1u) / block_size * block_size);
+			chunks.push_back(chunk.get());
+			chunk.release();
+			for (size_t i = blocksPerChunk; i-- != 0u;)
+			{
+				freeBlocks.push_back(firstBlock + i * block_size);
+			}
+		}
+		void* block = freeBlocks.back();
+		freeBlocks.pop_back();
+		return block;
+	}
+
+	void release(void* block)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		freeBlocks.push_back(block);
+	}
+};
+
+/*
+* Allocates elements for one thread from blocks taken from a SlabBlockPool. Allocating never touches anything shared except to take a new block,
+* and each thread fills its own blocks so nodes of different threads don't share cache lines.
+* Unlike a StackSlabAllocator, any thread can release an element with release, and a block goes back to the pool once all its elements have
+* been released and the allocator has moved on to another block. Elements that are never released are freed along with the pool.
+*/
+template<size_t element_size, size_t element_align, size_t block_size = 65536u>
+class ThreadSlabAllocator
+{
+public:
+	using Pool = SlabBlockPool<block_size>;
+private:
+	constexpr static size_t cacheLineSize = 64u;
+
+	/*
+	* Starts each block on its own cache line. live counts the elements not yet released plus one while the block belongs to an allocator,
+	* counting every element the allocator hasn't handed out yet as live until it moves on.
+	*/
+	struct BlockHeader
+	{
+		std::atomic<size_t> live;
+		Pool* pool;
+	};
+	constexpr static size_t elementAlign = element_align > cacheLineSize ? element_align : cacheLineSize;
+	constexpr static size_t headerSize = (sizeof(BlockHeader) + elementAlign - 1u) / elementAlign * elementAlign;
+	constexpr static size_t elementStride = (element_size + element_align - 1u) / element_align * element_align;
+	constexpr static size_t elementsPerBlock = (block_size - headerSize) / elementStride;
+	static_assert(block_size > headerSize && elementsPerBlock != 0u, "block_size is too small for even one element");
+
+	Pool& pool;
+	char* block = nullptr;
+	size_t used = 0u;
+
+	static void releaseReferences(BlockHeader* header, size_t count)
+	{
+		if (header->live.fetch_sub(count, std::memory_order_acq_rel) == count)
+		{
+			header->~BlockHeader();
+			header->pool->release(header);
+		}
+	}
+
+	void retireBlock()
+	{
+		if (block != nullptr) releaseReferences(reinterpret_cast<BlockHeader*>(block), elementsPerBlock - used + 1u);
+		block = nullptr;
+	}
+public:
+	explicit ThreadSlabAllocator(Pool& pool) noexcept : pool(pool) {}
+
+	ThreadSlabAllocator(const ThreadSlabAllocator&) = delete;
+	ThreadSlabAllocator& operator=(const ThreadSlabAllocator&) = delete;
+
+	~ThreadSlabAllocator()
+	{
+		retireBlock();
+	}
+
+	void* getNext()
+	{
+		if (block == nullptr || used == elementsPerBlock)
+		{
+			void* newBlock = pool.acquire();
+			retireBlock();
+			block = static_cast<char*>(newBlock);
+			new(block) BlockHeader{ { elementsPerBlock + 1u }, &pool };
+			used = 0u;
+		}
+		return block + headerSize + elementStride * used++;
+	}
+
+	/*
+	* Gives back the element returned by the last call to getNext, which must not have been handed to another thread.
+	*/
+	void replaceLast() noexcept
+	{
+		--used;
+	}
+
+	/*
+	* Frees an element from any allocator using the same block_size. Can be called from any thread.
+	*/
+	static void release(void* element)
+	{
+		const uintptr_t address = reinterpret_cast<uintptr_t>(element);
+		releaseReferences(reinterpret_cast<BlockHeader*>(address / block_size * block_size), 1u);
+	}
+};
@@ -0,0 +1,84 @@
+#pragma once
+#include "HashMap.h"
+#include <cstdint>
+
+/*
+* A fixed size table storing the fewest moves each state has been reached in during one iteration of a depth first search.
+* It is a HashMap given all its buckets up front and only filled with insertBounded, so it uses HashMap's Robin Hood probing but never
+* grows. No entry is stored more than maxProbeDistance buckets past its ideal bucket; when there is no room the entry that was reached in
+* fewer moves is kept because it prunes a larger subtree.
+*/
+class TranspositionTable
+{
+public:
+	struct Entry
+	{
+		uint64_t key;
+		unsigned int g;
+		unsigned int pruningState;
+	};
+private:
+	struct Hasher
+	{
+		size_t operator()(const Entry& entry) const
+		{
+			uint64_t key = entry.key;
+			key ^= key >> 31u;
+			key *= 0x7fb5d329728ea185ull;
+			key ^= key >> 27u;
+			return (size_t)key;
+		}
+	};
+
+	struct EqualTo
+	{
+		bool operator()(const Entry& a, const Entry& b) const
+		{
+			return a.key == b.key;
+		}
+	};
+
+	constexpr static size_t maxProbeDistance = 16u;
+
+	HashMap<Entry, Hasher, EqualTo> entries;
+
+	/*
+	* The largest power of two number of buckets that fits in sizeInBytes, but always at least one. Each bucket also stores its distance
+	* from the entry's ideal bucket.
+	*/
+	static size_t bucketCount(size_t sizeInBytes)
+	{
+		constexpr size_t bucketSize = sizeof(Entry) + sizeof(size_t);
+		size_t count = 1u;
+		while (count * 2u * bucketSize <= sizeInBytes)
+		{
+			count *= 2u;
+		}
+		return count;
+	}
+public:
+	explicit TranspositionTable(size_t sizeInBytes) : entries(bucketCount(sizeInBytes)) {}
+
+	/*
+	* Forgets every entry.
+	*/
+	void startIteration()
+	{
+		if (entries.size() != 0u) entries.clear();
+	}
+
+	Entry* find(uint64_t key)
+	{
+		auto entry = entries.find(Entry{ key, 0u, 0u });
+		return entry != entries.end() ? &*entry : nullptr;
+	}
+
+	/*
+	* Adds a state that isn't already in the table. The state or another entry might be dropped if the table is too full.
+	*/
+	void insert(uint64_t key, unsigned int g, unsigned int pruningState)
+	{
+		entries.insertBounded(Entry{ key, g, pruningState }, maxProbeDistance,
+			[](const Entry& occupant, const Entry& entry) { return entry.g < occupant.g; });
+	}
+};
\ No newline at end of file
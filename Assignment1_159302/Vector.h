@@ -99,6 +99,16 @@ public:
 		return mData[pos];
 	}
 
+	reference back() noexcept
+	{
+		return *(mEnd - 1u);
+	}
+
+	const_reference back() const noexcept
+	{
+		return *(mEnd - 1u);
+	}
+
 	void pop_back()
 	{
 		--mEnd;
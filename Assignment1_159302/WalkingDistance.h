@@ -0,0 +1,183 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include "Vector.h"
+#include "HashMap.h"
+
+/*
+* The walking distance of the tiles along one axis of the board.
+* A pattern records, for every line (row or column) of the board, how many of its tiles belong in each line. Only the empty tile can
+* move between lines so the number of moves needed to turn a pattern into the goal pattern is a lower bound on the moves needed to
+* solve the puzzle. The distance of every pattern is found with a breadth-first search back from the goal pattern.
+* Rows use WalkingDistanceTable<height, width> and columns use WalkingDistanceTable<width, height>.
+*/
+template<size_t lineCount, size_t lineLength>
+class WalkingDistanceTable
+{
+	constexpr static size_t bitsPerCount = lineLength < 2u ? 1u : lineLength < 4u ? 2u : lineLength < 8u ? 3u : 4u;
+	static_assert(lineCount * lineCount * bitsPerCount <= 64u, "A walking distance pattern must fit in 64 bits");
+	constexpr static uint64_t countMask = (uint64_t(1u) << bitsPerCount) - 1u;
+
+	struct PatternId
+	{
+		uint64_t key;
+		unsigned int id;
+	};
+
+	struct PatternIdHasher
+	{
+		size_t operator()(const PatternId& value) const
+		{
+			return (size_t)(value.key * 0x9e3779b97f4a7c15ull >> 16u);
+		}
+	};
+
+	struct PatternIdEqualityTester
+	{
+		bool operator()(const PatternId& value1, const PatternId& value2) const
+		{
+			return value1.key == value2.key;
+		}
+	};
+
+	HashMap<PatternId, PatternIdHasher, PatternIdEqualityTester> ids;
+	Vector<unsigned char> distances;
+	Vector<unsigned int> transitions;
+
+	static size_t shift(size_t line, size_t goalLine)
+	{
+		return (line * lineCount + goalLine) * bitsPerCount;
+	}
+
+	static size_t count(uint64_t pattern, size_t line, size_t goalLine)
+	{
+		return (size_t)((pattern >> shift(line, goalLine)) & countMask);
+	}
+public:
+	/*
+	* Returned by next() for moves that can't be made.
+	*/
+	constexpr static unsigned int none = std::numeric_limits<unsigned int>::max();
+
+	/*
+	* Adds a tile in line that belongs in goalLine to pattern.
+	*/
+	static uint64_t addTile(uint64_t pattern, size_t line, size_t goalLine)
+	{
+		return pattern + (uint64_t(1u) << shift(line, goalLine));
+	}
+
+	explicit WalkingDistanceTable(size_t goalEmptyLine)
+	{
+		uint64_t goalPattern = 0u;
+		for (size_t line = 0u; line != lineCount; ++line)
+		{
+			for (size_t i = line == goalEmptyLine ? 1u : 0u; i != lineLength; ++i)
+			{
+				goalPattern = addTile(goalPattern, line, line);
+			}
+		}
+
+		Vector<uint64_t> patterns;
+		Vector<unsigned char> emptyLines;
+		patterns.push_back(goalPattern);
+		emptyLines.push_back((unsigned char)goalEmptyLine);
+		distances.push_back(0u);
+		ids.insert(PatternId{ goalPattern, 0u });
+
+		for (size_t current = 0u; current != patterns.size(); ++current)
+		{
+			const uint64_t pattern = patterns[current];
+			const size_t emptyLine = emptyLines[current];
+			for (size_t direction = 0u; direction != 2u; ++direction)
+			{
+				for (size_t goalLine = 0u; goalLine != lineCount; ++goalLine)
+				{
+					transitions.push_back(none);
+				}
+				if (direction == 0u ? emptyLine == 0u : emptyLine == lineCount - 1u) continue;
+				const size_t newEmptyLine = direction == 0u ? emptyLine - 1u : emptyLine + 1u;
+
+				//A tile from the line the empty tile moves to goes to the line the empty tile left
+				for (size_t goalLine = 0u; goalLine != lineCount; ++goalLine)
+				{
+					if (count(pattern, newEmptyLine, goalLine) == 0u) continue;
+					const uint64_t newPattern = addTile(pattern - (uint64_t(1u) << shift(newEmptyLine, goalLine)), emptyLine, goalLine);
+					auto existing = ids.find(PatternId{ newPattern, 0u });
+					unsigned int newId;
+					if (existing != ids.end())
+					{
+						newId = (*existing).id;
+					}
+					else
+					{
+						newId = (unsigned int)patterns.size();
+						patterns.push_back(newPattern);
+						emptyLines.push_back((unsigned char)newEmptyLine);
+						distances.push_back((unsigned char)(distances[current] + 1u));
+						ids.insert(PatternId{ newPattern, newId });
+					}
+					transitions[(current * 2u + direction) * lineCount + goalLine] = newId;
+				}
+			}
+		}
+	}
+
+	/*
+	* Finds the id of a pattern built with addTile().
+	*/
+	unsigned int find(uint64_t pattern) const
+	{
+		auto existing = ids.find(PatternId{ pattern, 0u });
+		return existing != ids.end() ? (*existing).id : none;
+	}
+
+	/*
+	* The pattern after the empty tile moves to the previous line (direction 0) or the next line (direction 1), swapping with a tile
+	* that belongs in goalLine.
+	*/
+	unsigned int next(unsigned int pattern, size_t direction, size_t goalLine) const
+	{
+		return transitions[(pattern * 2u + direction) * lineCount + goalLine];
+	}
+
+	unsigned int distance(unsigned int pattern) const
+	{
+		return distances[pattern];
+	}
+
+	size_t size() const
+	{
+		return distances.size();
+	}
+};
+
+//C++11 needs the constant defined outside the class too once it is passed by reference, as push_back does
+template<size_t lineCount, size_t lineLength>
+constexpr unsigned int WalkingDistanceTable<lineCount, lineLength>::none;
+
+/*
+* Builds the table for a goal with its empty tile in goalEmptyLine the first time it is needed. Tables are never freed so threads can
+* use one without a lock once it has been built, and only threads wanting a table that isn't built yet wait for each other.
+*/
+template<size_t lineCount, size_t lineLength>
+const WalkingDistanceTable<lineCount, lineLength>& getWalkingDistanceTable(size_t goalEmptyLine)
+{
+	static std::atomic<const WalkingDistanceTable<lineCount, lineLength>*> tables[lineCount];
+	const WalkingDistanceTable<lineCount, lineLength>* table = tables[goalEmptyLine].load(std::memory_order_acquire);
+	if (table == nullptr)
+	{
+		static std::mutex mutex;
+		std::lock_guard<std::mutex> lock(mutex);
+		table = tables[goalEmptyLine].load(std::memory_order_relaxed);
+		if (table == nullptr)
+		{
+			table = new WalkingDistanceTable<lineCount, lineLength>(goalEmptyLine);
+			tables[goalEmptyLine].store(table, std::memory_order_release);
+		}
+	}
+	return *table;
+}
\ No newline at end of file
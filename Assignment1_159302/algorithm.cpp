@@ -5,11 +5,54 @@
 #include "PriorityQueue.h"
 #include "Vector.h"
 #include "StackSlabAllocator.h"
+#include "ThreadSlabAllocator.h"
+#include "MovePruningAutomaton.h"
+#include "TranspositionTable.h"
+#include "TableCache.h"
+#include "WalkingDistance.h"
+#include "PatternDatabase.h"
+#include "MessageQueue.h"
+#include "MultiQueue.h"
+#include "ConcurrentHashMap.h"
+#include "SocketChannel.h"
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <mutex>
+#include <random>
 
 using namespace std;
 
 #define USE_HASH_MAP
 
+/*
+* The length of the longest move sequences checked for duplicates by the MovePruningAutomaton.
+*/
+constexpr unsigned int movePruningDepth = 12u;
+//Searches only look at their CancellationToken once every cancellationCheckMask + 1 expansions
+constexpr int cancellationCheckMask = 1023;
+//Each pattern database covers this many tiles plus the empty tile
+constexpr size_t patternDatabaseTileCount = 4u;
+constexpr size_t maxPatternDatabaseCount = 6u;
+//How many pattern database sets and how many perimeters are kept for reuse after the searches using them finish
+constexpr size_t tableCacheCapacity = 4u;
+
+/*
+* Returns true if a search with this many expansions so far should give up, only looking at the token every so often.
+*/
+inline bool shouldStop(const CancellationToken* cancellation, int numOfStateExpansions)
+{
+	return cancellation != nullptr && (numOfStateExpansions & cancellationCheckMask) == 0 && cancellation->isCancelled();
+}
+
+/*
+* What a search stopped by its CancellationToken returns instead of a path.
+*/
+inline string stoppedPath(const CancellationToken* cancellation)
+{
+	return cancellation->hasTimedOut() ? "TIMEOUT" : "CANCELLED";
+}
+
 template<class T, class H, class E>
 #ifdef USE_HASH_MAP
 using VisitedList = HashMap<T, H, E>;
@@ -53,6 +96,7 @@ template<size_t width, size_t height, class TileType = char>
 struct MapWithDepth : Map<width, height, TileType>
 {
 	unsigned int depth;
+	unsigned int pruningState;
 };
 
 /*
@@ -87,11 +131,63 @@ struct LocationTracker
 	}
 };
 
+/*
+* Anything a heuristic needs to remember about a state to update its value incrementally.
+*/
+template<heuristicFunction heuristic>
+struct HeuristicState {};
+
+/*
+* The walking distance patterns of the rows and columns of a state.
+*/
+template<>
+struct HeuristicState<walkingDistance>
+{
+	unsigned int rowPattern;
+	unsigned int columnPattern;
+};
+
+/*
+* The exact distance from each pattern database, needed to decode the mod 3 values of the children.
+*/
+template<>
+struct HeuristicState<patternDatabase>
+{
+	unsigned char patternDatabaseDistances[maxPatternDatabaseCount];
+};
+
+/*
+* The pattern database distances plus the largest distance of the dual state, which is 0 if it wasn't looked up.
+* pathmaxRaise is how much pathmax has raised the state's heuristic value above the value it was calculated to have.
+*/
+template<>
+struct HeuristicState<dualPatternDatabase> : HeuristicState<patternDatabase>
+{
+	unsigned char dualDistance;
+	unsigned char pathmaxRaise;
+};
+
+/*
+* Heuristics that never drop by more than one move between neighbouring states. Searches only need pathmax with the others.
+*/
+constexpr bool isConsistent(heuristicFunction heuristic)
+{
+	return heuristic != dualPatternDatabase;
+}
+
+template<heuristicFunction heuristic>
+void recordPathmaxRaise(HeuristicState<heuristic>& /*state*/, unsigned int /*raise*/) {}
+
+inline void recordPathmaxRaise(HeuristicState<dualPatternDatabase>& state, unsigned int raise)
+{
+	state.pathmaxRaise = (unsigned char)(state.pathmaxRaise + raise);
+}
+
 /*
 * Stores the state of the puzzle plus its heuristic information used by A*
 */
-template<size_t width, size_t height, class TileType = char>
-struct MapWithHuristic : Map<width, height, TileType>
+template<size_t width, size_t height, class TileType = char, heuristicFunction heuristic = misplacedTiles>
+struct MapWithHuristic : Map<width, height, TileType>, HeuristicState<heuristic>
 {
 	unsigned int g;
 	unsigned int f;
@@ -201,12 +297,13 @@ struct GreaterHeuisticTracker
 /*
 * Converts a path as a linked list of states into a std:string of moves.
 */
-template<size_t width, size_t height, class TileType, template<size_t, size_t, class> class Map>
-static std::string packPath(ListNode<Map<width, height, TileType>>* finalPath)
+template<class Map>
+static std::string packPath(ListNode<Map>* finalPath)
 {
+	constexpr size_t width = Map::width;
 	std::string moves;
 	size_t length = 0u;
-	for (ListNode<Map<width, height, TileType>>* current = finalPath->next; current != nullptr; current = current->next)
+	for (ListNode<Map>* current = finalPath->next; current != nullptr; current = current->next)
 	{
 		++length;
 	}
@@ -308,6 +405,26 @@ void expandPathDepthLimited(Map& currentState, ListNode<Map>* currentPath, size_
 	posiblePaths.back()->data.depth = currentState.depth + 1u;
 }
 
+template<class Queue, class Map, class Automaton, class Allocator>
+void expandPathDepthLimitedPruned(Map& currentState, ListNode<Map>* currentPath, size_t newPos, size_t oldPos, size_t direction, Queue& posiblePaths,
+	const Automaton& automaton, Allocator& allocator)
+{
+	unsigned int pruningState = automaton.next(currentState.pruningState, direction);
+	if (pruningState == Automaton::pruned) return;
+	expandPathDepthLimited(currentState, currentPath, newPos, oldPos, posiblePaths, allocator);
+	posiblePaths.back()->data.pruningState = pruningState;
+}
+
+/*
+* The move pruning automaton shared by all searches on a board of the given size. It is built the first time it is needed.
+*/
+template<size_t width, size_t height>
+const MovePruningAutomaton<width, height>& getMovePruningAutomaton()
+{
+	static const MovePruningAutomaton<width, height> automaton(movePruningDepth);
+	return automaton;
+}
+
 
 ///////////////////////////////////////////////////////////////////////////////////////////
 //
@@ -316,7 +433,8 @@ void expandPathDepthLimited(Map& currentState, ListNode<Map>* currentPath, size_
 // Move Generator:  
 //
 ////////////////////////////////////////////////////////////////////////////////////////////
-string breadthFirstSearch(string const& initialState, string const& goalState, int &numOfStateExpansions, int& maxQLength, float &actualRunningTime){
+string breadthFirstSearch(string const& initialState, string const& goalState, int &numOfStateExpansions, int& maxQLength, float &actualRunningTime,
+	const CancellationToken* cancellation){
     string path;
 	clock_t startTime;
     //add necessary variables here
@@ -372,8 +490,14 @@ string breadthFirstSearch(string const& initialState, string const& goalState, i
 		posiblePaths.emplace_back(currentNode);
 		maxQLength = 1;
 		bool foundGoal = false;
+		bool cancelled = false;
 		while (!posiblePaths.empty())
 		{
+			if (shouldStop(cancellation, numOfStateExpansions))
+			{
+				cancelled = true;
+				break;
+			}
 			ListNode<Map_t>* currentPath = posiblePaths.front();
 			if (currentPath->data == goal)
 			{
@@ -386,19 +510,21 @@ string breadthFirstSearch(string const& initialState, string const& goalState, i
 			size_t emptyPos = currentState.emptyPos;
 			size_t x = emptyPos % width;
 			size_t y = emptyPos / width;
-			if (y != 0u)
+			//Moving the empty tile back to where it just came from would only recreate the parent state
+			size_t parentPos = currentPath->next != nullptr ? currentPath->next->data.emptyPos : width * height;
+			if (y != 0u && emptyPos - width != parentPos)
 			{
 				expandPathDepthFirst(currentState, currentPath, emptyPos - width, emptyPos, posiblePaths, allocator);
 			}
-			if (x != width - 1u)
+			if (x != width - 1u && emptyPos + 1u != parentPos)
 			{
 				expandPathDepthFirst(currentState, currentPath, emptyPos + 1u, emptyPos, posiblePaths, allocator);
 			}
-			if (y != height - 1u)
+			if (y != height - 1u && emptyPos + width != parentPos)
 			{
 				expandPathDepthFirst(currentState, currentPath, emptyPos + width, emptyPos, posiblePaths, allocator);
 			}
-			if (x != 0u)
+			if (x != 0u && emptyPos - 1u != parentPos)
 			{
 				expandPathDepthFirst(currentState, currentPath, emptyPos - 1u, emptyPos, posiblePaths, allocator);
 			}
@@ -414,6 +540,10 @@ string breadthFirstSearch(string const& initialState, string const& goalState, i
 		{
 			path = packPath(posiblePaths.front());
 		}
+		else if (cancelled)
+		{
+			path = stoppedPath(cancellation);
+		}
 		else
 		{
 			path = "";
@@ -436,7 +566,8 @@ string breadthFirstSearch(string const& initialState, string const& goalState, i
 // Move Generator:  
 //
 ////////////////////////////////////////////////////////////////////////////////////////////
-string breadthFirstSearch_with_VisitedList(string const& initialState, string const& goalState, int &numOfStateExpansions, int& maxQLength, float &actualRunningTime){
+string breadthFirstSearch_with_VisitedList(string const& initialState, string const& goalState, int &numOfStateExpansions, int& maxQLength, float &actualRunningTime,
+	const CancellationToken* cancellation){
 	string path;
 	clock_t startTime;
 	//add necessary variables here
@@ -493,8 +624,14 @@ string breadthFirstSearch_with_VisitedList(string const& initialState, string co
 		visited.insert(&currentNode->data);
 		maxQLength = 1;
 		bool goalFount = false;
+		bool cancelled = false;
 		while (!posiblePaths.empty())
 		{
+			if (shouldStop(cancellation, numOfStateExpansions))
+			{
+				cancelled = true;
+				break;
+			}
 			ListNode<Map<width, height>>* currentPath = posiblePaths.front();
 			if (currentPath->data == goal)
 			{
@@ -507,19 +644,21 @@ string breadthFirstSearch_with_VisitedList(string const& initialState, string co
 			size_t emptyPos = currentState.emptyPos;
 			size_t x = emptyPos % width;
 			size_t y = emptyPos / width;
-			if (y != 0u)
+			//Moving the empty tile back to where it just came from would only recreate the parent state
+			size_t parentPos = currentPath->next != nullptr ? currentPath->next->data.emptyPos : width * height;
+			if (y != 0u && emptyPos - width != parentPos)
 			{
 				expandPathDepthFirstVisited(currentState, currentPath, emptyPos - width, emptyPos, posiblePaths, visited, allocator);
 			}
-			if (x != width - 1u)
+			if (x != width - 1u && emptyPos + 1u != parentPos)
 			{
 				expandPathDepthFirstVisited(currentState, currentPath, emptyPos + 1u, emptyPos, posiblePaths, visited, allocator);
 			}
-			if (y != height - 1u)
+			if (y != height - 1u && emptyPos + width != parentPos)
 			{
 				expandPathDepthFirstVisited(currentState, currentPath, emptyPos + width, emptyPos, posiblePaths, visited, allocator);
 			}
-			if (x != 0u)
+			if (x != 0u && emptyPos - 1u != parentPos)
 			{
 				expandPathDepthFirstVisited(currentState, currentPath, emptyPos - 1u, emptyPos, posiblePaths, visited, allocator);
 			}
@@ -535,6 +674,10 @@ string breadthFirstSearch_with_VisitedList(string const& initialState, string co
 		{
 			path = packPath(posiblePaths.front());
 		}
+		else if (cancelled)
+		{
+			path = stoppedPath(cancellation);
+		}
 		else
 		{
 			path = "";
@@ -551,6 +694,213 @@ string breadthFirstSearch_with_VisitedList(string const& initialState, string co
 	return path;
 }
 
+/*
+* The position of a state in the lexicographic order of all permutations of its tiles, from 0 to tileCount! - 1.
+*/
+template<class Map>
+size_t permutationRank(const Map& state)
+{
+	constexpr size_t tileCount = Map::width * Map::height;
+	size_t rank = 0u;
+	for (size_t i = 0u; i != tileCount; ++i)
+	{
+		size_t smallerTilesAfter = 0u;
+		for (size_t j = i + 1u; j != tileCount; ++j)
+		{
+			if (state.tiles[j] < state.tiles[i]) ++smallerTilesAfter;
+		}
+		rank = rank * (tileCount - i) + smallerTilesAfter;
+	}
+	return rank;
+}
+
+/*
+* Breadth-first search with a visited list that expands each level on threadCount threads, or one per core if threadCount is 0.
+* The threads take chunks of the current level and claim children in a visited bitset indexed by permutation rank with an atomic or.
+* The thread that claims a state records the move that reached it, so the path is found by walking back from the goal, and adds it
+* to its own buffer for the next level. The buffers are joined into the next level once every thread has finished.
+* actualRunningTime is wall clock time because clock() adds up the time of every thread.
+*/
+string breadthFirstSearch_with_VisitedList_Parallel(string const& initialState, string const& goalState, int &numOfStateExpansions, int& maxQLength,
+	float &actualRunningTime, unsigned int threadCount, const CancellationToken* cancellation){
+	string path;
+
+	constexpr size_t width = 3, height = 3;
+	constexpr size_t tileCount = width * height;
+	using Map_t = Map<width, height>;
+	using Word = std::atomic<uint64_t>;
+	constexpr size_t bitsPerWord = 64u;
+	constexpr size_t statesPerChunk = 256u;
+	Map_t goal;
+	Map_t initial;
+
+	numOfStateExpansions = 0;
+	maxQLength = 1;
+	if (threadCount == 0u) threadCount = std::thread::hardware_concurrency();
+	if (threadCount == 0u) threadCount = 1u;
+
+	const auto startTime = std::chrono::steady_clock::now();
+
+	try
+	{
+
+		for (size_t i = 0; i != goalState.size(); ++i)
+		{
+			if (goalState[i] == '0')
+			{
+				goal.tiles[i] = 0;
+				goal.emptyPos = i;
+			}
+			else
+			{
+				goal.tiles[i] = goalState[i] - '0';
+			}
+		}
+
+		for (size_t i = 0; i != initialState.size(); ++i)
+		{
+			if (initialState[i] == '0')
+			{
+				initial.tiles[i] = 0;
+				initial.emptyPos = i;
+			}
+			else
+			{
+				initial.tiles[i] = initialState[i] - '0';
+			}
+		}
+
+		size_t stateCount = 1u;
+		for (size_t i = 2u; i <= tileCount; ++i)
+		{
+			stateCount *= i;
+		}
+		std::unique_ptr<Word[]> visited(new Word[(stateCount + bitsPerWord - 1u) / bitsPerWord]());
+		//Only written by the thread that claims a state and only read once all the threads have finished
+		std::unique_ptr<char[]> moves(new char[stateCount]);
+		std::unique_ptr<Vector<Map_t>[]> buffers(new Vector<Map_t>[threadCount]);
+		Vector<Map_t> level;
+
+		const size_t initialRank = permutationRank(initial);
+		visited[initialRank / bitsPerWord].store(uint64_t(1u) << initialRank % bitsPerWord, std::memory_order_relaxed);
+		level.push_back(initial);
+		bool goalFound = initial == goal;
+		std::atomic<int> expansions(0);
+		bool cancelled = false;
+
+		while (!goalFound && !level.empty())
+		{
+			std::atomic<size_t> nextChunk(0u);
+			std::atomic<unsigned int> nextBuffer(0u);
+			std::atomic<bool> foundGoal(false);
+			std::atomic<bool> outOfMemory(false);
+			std::atomic<bool> stopped(false);
+			runOnThreads(threadCount, [&]()
+			{
+				Vector<Map_t>& buffer = buffers[nextBuffer.fetch_add(1u, std::memory_order_relaxed)];
+				int expanded = 0;
+				try
+				{
+					for (size_t first = nextChunk.fetch_add(statesPerChunk, std::memory_order_relaxed); first < level.size();
+						first = nextChunk.fetch_add(statesPerChunk, std::memory_order_relaxed))
+					{
+						if (cancellation != nullptr && cancellation->isCancelled())
+						{
+							stopped.store(true, std::memory_order_relaxed);
+							break;
+						}
+						const size_t last = first + statesPerChunk < level.size() ? first + statesPerChunk : level.size();
+						for (size_t i = first; i != last; ++i)
+						{
+							const Map_t& state = level[i];
+							const size_t emptyPos = state.emptyPos;
+							const size_t newPositions[4] = { emptyPos - width, emptyPos + 1u, emptyPos + width, emptyPos - 1u };
+							const bool canMove[4] = { emptyPos / width != 0u, emptyPos % width != width - 1u, emptyPos / width != height - 1u, emptyPos % width != 0u };
+							const char moveNames[4] = { 'U', 'R', 'D', 'L' };
+							for (size_t direction = 0u; direction != 4u; ++direction)
+							{
+								if (!canMove[direction]) continue;
+								Map_t child = state;
+								child.tiles[emptyPos] = child.tiles[newPositions[direction]];
+								child.tiles[newPositions[direction]] = 0;
+								child.emptyPos = newPositions[direction];
+								const size_t rank = permutationRank(child);
+								const uint64_t bit = uint64_t(1u) << rank % bitsPerWord;
+								if ((visited[rank / bitsPerWord].fetch_or(bit, std::memory_order_relaxed) & bit) != 0u) continue;
+								moves[rank] = moveNames[direction];
+								buffer.push_back(child);
+								if (child == goal) foundGoal.store(true, std::memory_order_relaxed);
+							}
+							++expanded;
+						}
+					}
+				}
+				catch (std::bad_alloc)
+				{
+					outOfMemory.store(true, std::memory_order_relaxed);
+				}
+				expansions.fetch_add(expanded, std::memory_order_relaxed);
+			});
+			if (outOfMemory.load(std::memory_order_relaxed)) throw std::bad_alloc();
+			goalFound = foundGoal.load(std::memory_order_relaxed);
+			//A goal found in a level that wasn't finished is still at the smallest depth it can be
+			if (!goalFound && stopped.load(std::memory_order_relaxed))
+			{
+				cancelled = true;
+				break;
+			}
+
+			level.clear();
+			for (unsigned int i = 0u; i != threadCount; ++i)
+			{
+				for (const Map_t& state : buffers[i])
+				{
+					level.push_back(state);
+				}
+				buffers[i].clear();
+			}
+			if (level.size() > (size_t)maxQLength)
+			{
+				maxQLength = (int)level.size();
+			}
+		}
+		numOfStateExpansions = expansions.load(std::memory_order_relaxed);
+
+		if (goalFound)
+		{
+			Map_t state = goal;
+			while (state != initial)
+			{
+				const char move = moves[permutationRank(state)];
+				path.push_back(move);
+				const size_t emptyPos = state.emptyPos;
+				const size_t oldPos = move == 'U' ? emptyPos + width : move == 'R' ? emptyPos - 1u : move == 'D' ? emptyPos - width : emptyPos + 1u;
+				state.tiles[emptyPos] = state.tiles[oldPos];
+				state.tiles[oldPos] = 0;
+				state.emptyPos = oldPos;
+			}
+			std::reverse(path.begin(), path.end());
+		}
+		else if (cancelled)
+		{
+			path = stoppedPath(cancellation);
+		}
+		else
+		{
+			path = "";
+		}
+
+	}
+	catch (std::bad_alloc)
+	{
+		path = "OOM";
+	}
+
+	actualRunningTime = std::chrono::duration<float>(std::chrono::steady_clock::now() - startTime).count();
+
+	return path;
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////
 //
 // Search Algorithm:  
@@ -558,7 +908,8 @@ string breadthFirstSearch_with_VisitedList(string const& initialState, string co
 // Move Generator:  
 //
 ////////////////////////////////////////////////////////////////////////////////////////////
-string progressiveDeepeningSearch_No_VisitedList(string const& initialState, string const& goalState, int &numOfStateExpansions, int& maxQLength, float &actualRunningTime, int ultimateMaxDepth){
+string progressiveDeepeningSearch_No_VisitedList(string const& initialState, string const& goalState, int &numOfStateExpansions, int& maxQLength, float &actualRunningTime, int ultimateMaxDepth,
+	const CancellationToken* cancellation){
     string path;
 	clock_t startTime;
 	//add necessary variables here
@@ -571,6 +922,7 @@ string progressiveDeepeningSearch_No_VisitedList(string const& initialState, str
 	ListNode<Map_t>* currentNode;
 	StackSlabAllocator<sizeof(ListNode<Map_t>), alignof(ListNode<Map_t>), (sizeof(ListNode<Map_t>) + sizeof(void*) > 204u ? 20u :
 		(4096u - sizeof(void*)) / sizeof(ListNode<Map_t>) * sizeof(ListNode<Map_t>))> allocator;
+	const MovePruningAutomaton<width, height>& automaton = getMovePruningAutomaton<width, height>();
 
     //algorithm implementation
 	// cout << "------------------------------" << endl;
@@ -610,17 +962,24 @@ string progressiveDeepeningSearch_No_VisitedList(string const& initialState, str
 			}
 		}
 		currentNode->data.depth = 0u;
+		currentNode->data.pruningState = automaton.start(currentNode->data.emptyPos);
 
 		posiblePaths.emplace_back(currentNode);
 		auto start = currentNode;
 		maxQLength = 1;
 
 		bool goalFound = false;
+		bool cancelled = false;
 		while (true)
 		{
 			bool solutionMightExist = false;
 			while (!posiblePaths.empty())
 			{
+				if (shouldStop(cancellation, numOfStateExpansions))
+				{
+					cancelled = true;
+					break;
+				}
 				ListNode<MapWithDepth<width, height>>* currentPath = posiblePaths.back();
 				if (currentPath->data == goal)
 				{
@@ -635,21 +994,23 @@ string progressiveDeepeningSearch_No_VisitedList(string const& initialState, str
 					size_t emptyPos = currentState.emptyPos;
 					size_t x = emptyPos % width;
 					size_t y = emptyPos / width;
-					if (y != 0u)
+					//Moving the empty tile back to where it just came from would only recreate the parent state
+					size_t parentPos = currentPath->next != nullptr ? currentPath->next->data.emptyPos : width * height;
+					if (y != 0u && emptyPos - width != parentPos)
 					{
-						expandPathDepthLimited(currentState, currentPath, emptyPos - width, emptyPos, posiblePaths, allocator);
+						expandPathDepthLimitedPruned(currentState, currentPath, emptyPos - width, emptyPos, 0u, posiblePaths, automaton, allocator);
 					}
-					if (x != width - 1u)
+					if (x != width - 1u && emptyPos + 1u != parentPos)
 					{
-						expandPathDepthLimited(currentState, currentPath, emptyPos + 1u, emptyPos, posiblePaths, allocator);
+						expandPathDepthLimitedPruned(currentState, currentPath, emptyPos + 1u, emptyPos, 1u, posiblePaths, automaton, allocator);
 					}
-					if (y != height - 1u)
+					if (y != height - 1u && emptyPos + width != parentPos)
 					{
-						expandPathDepthLimited(currentState, currentPath, emptyPos + width, emptyPos, posiblePaths, allocator);
+						expandPathDepthLimitedPruned(currentState, currentPath, emptyPos + width, emptyPos, 2u, posiblePaths, automaton, allocator);
 					}
-					if (x != 0u)
+					if (x != 0u && emptyPos - 1u != parentPos)
 					{
-						expandPathDepthLimited(currentState, currentPath, emptyPos - 1u, emptyPos, posiblePaths, allocator);
+						expandPathDepthLimitedPruned(currentState, currentPath, emptyPos - 1u, emptyPos, 3u, posiblePaths, automaton, allocator);
 					}
 
 					if (posiblePaths.size() > (unsigned int)maxQLength)
@@ -663,7 +1024,7 @@ string progressiveDeepeningSearch_No_VisitedList(string const& initialState, str
 				}
 				++numOfStateExpansions;
 			}
-			if (goalFound || !solutionMightExist) break;
+			if (goalFound || cancelled || !solutionMightExist) break;
 			++maxDepthLimit;
 			posiblePaths.push_back(start);
 		}
@@ -672,6 +1033,10 @@ string progressiveDeepeningSearch_No_VisitedList(string const& initialState, str
 		{
 			path = packPath(posiblePaths.back());
 		}
+		else if (cancelled)
+		{
+			path = stoppedPath(cancellation);
+		}
 		else
 		{
 			path = "";
@@ -699,7 +1064,8 @@ string progressiveDeepeningSearch_No_VisitedList(string const& initialState, str
 // Move Generator:  
 //
 ////////////////////////////////////////////////////////////////////////////////////////////
-string progressiveDeepeningSearch_with_NonStrict_VisitedList(string const& initialState, string const& goalState, int &numOfStateExpansions, int& maxQLength, float &actualRunningTime, int ultimateMaxDepth){
+string progressiveDeepeningSearch_with_NonStrict_VisitedList(string const& initialState, string const& goalState, int &numOfStateExpansions, int& maxQLength, float &actualRunningTime, int ultimateMaxDepth,
+	const CancellationToken* cancellation){
     string path;
 	clock_t startTime;
     //add necessary variables here
@@ -759,11 +1125,17 @@ string progressiveDeepeningSearch_with_NonStrict_VisitedList(string const& initi
 		maxQLength = 1;
 
 		bool goalFound = false;
+		bool cancelled = false;
 		while (true)
 		{
 			bool solutionMightExist = false;
 			while (!posiblePaths.empty())
 			{
+				if (shouldStop(cancellation, numOfStateExpansions))
+				{
+					cancelled = true;
+					break;
+				}
 				ListNode<MapWithDepth<width, height>>* currentPath = posiblePaths.back();
 				if (currentPath->data == goal)
 				{
@@ -778,19 +1150,21 @@ string progressiveDeepeningSearch_with_NonStrict_VisitedList(string const& initi
 					size_t emptyPos = currentState.emptyPos;
 					size_t x = emptyPos % width;
 					size_t y = emptyPos / width;
-					if (y != 0u)
+					//Moving the empty tile back to where it just came from would only recreate the parent state
+					size_t parentPos = currentPath->next != nullptr ? currentPath->next->data.emptyPos : width * height;
+					if (y != 0u && emptyPos - width != parentPos)
 					{
 						expandPathDepthLimitedVisited(currentState, currentPath, emptyPos - width, emptyPos, posiblePaths, visited, allocator);
 					}
-					if (x != width - 1u)
+					if (x != width - 1u && emptyPos + 1u != parentPos)
 					{
 						expandPathDepthLimitedVisited(currentState, currentPath, emptyPos + 1u, emptyPos, posiblePaths, visited, allocator);
 					}
-					if (y != height - 1u)
+					if (y != height - 1u && emptyPos + width != parentPos)
 					{
 						expandPathDepthLimitedVisited(currentState, currentPath, emptyPos + width, emptyPos, posiblePaths, visited, allocator);
 					}
-					if (x != 0u)
+					if (x != 0u && emptyPos - 1u != parentPos)
 					{
 						expandPathDepthLimitedVisited(currentState, currentPath, emptyPos - 1u, emptyPos, posiblePaths, visited, allocator);
 					}
@@ -806,7 +1180,7 @@ string progressiveDeepeningSearch_with_NonStrict_VisitedList(string const& initi
 				}
 				++numOfStateExpansions;
 			}
-			if (goalFound || !solutionMightExist) break;
+			if (goalFound || cancelled || !solutionMightExist) break;
 			++maxDepthLimit;
 			posiblePaths.push_back(start);
 			visited.clear();
@@ -817,6 +1191,10 @@ string progressiveDeepeningSearch_with_NonStrict_VisitedList(string const& initi
 		{
 			path = packPath(posiblePaths.back());
 		}
+		else if (cancelled)
+		{
+			path = stoppedPath(cancellation);
+		}
 		else
 		{
 			path = "";
@@ -837,8 +1215,8 @@ string progressiveDeepeningSearch_with_NonStrict_VisitedList(string const& initi
 /*
 * Calculates the sum of mantattan distance of all tiles from their goal states based on the previous sum and the move taken.
 */
-template<bool useManhattanDistance, class Node, class Map, class Goal>
-typename std::enable_if<useManhattanDistance, void>::type calculateHeuristic(Node* currentNode, Map& currentState, Goal& goal, unsigned int oldPos, unsigned int newPos)
+template<heuristicFunction heuristic, class Node, class Map, class Goal>
+typename std::enable_if<heuristic == manhattanDistance, void>::type calculateHeuristic(Node* currentNode, Map& currentState, Goal& goal, unsigned int oldPos, unsigned int newPos)
 {
 	unsigned int index = 0u;
 	for (;; ++index)
@@ -873,8 +1251,8 @@ typename std::enable_if<useManhattanDistance, void>::type calculateHeuristic(Nod
 /*
 * Calculates the number of misplaced tiles from their goal states based on the previous number and the move taken.
 */
-template<bool useManhattanDistance, class Node, class Map, class Goal>
-typename std::enable_if<!useManhattanDistance, void>::type calculateHeuristic(Node* currentNode, Map& currentState, Goal& goal, unsigned int oldPos, unsigned int newPos)
+template<heuristicFunction heuristic, class Node, class Map, class Goal>
+typename std::enable_if<heuristic == misplacedTiles, void>::type calculateHeuristic(Node* currentNode, Map& currentState, Goal& goal, unsigned int oldPos, unsigned int newPos)
 {
 	unsigned int g2 = currentState.g;
 	if (currentNode->data.tiles[oldPos] == goal.tiles[newPos])
@@ -889,120 +1267,3823 @@ typename std::enable_if<!useManhattanDistance, void>::type calculateHeuristic(No
 	currentNode->data.g = g2;
 }
 
-template<bool useManhattanDistance, class Queue, class Expanded, class Map, class Map2, class Allocator
-#ifdef USE_HASH_MAP
-	, class QueueLookup
-#endif
-	>
-void expandAStarExpanded(const Map& currentState, ListNode<Map>* currentPath, size_t newPos, size_t oldPos, Queue& posiblePaths,
-	Expanded& expanded, const Map2& goal, Allocator& allocator, int& numOfDeletionsFromMiddleOfHeap, int& numOfAttemptedNodeReExpansions
-#ifdef USE_HASH_MAP
-	, QueueLookup& queueLookup
-#endif
-	)
+/*
+* Finds where tile is in the goal state.
+*/
+template<class Goal, class TileType>
+size_t goalPosition(const Goal& goal, TileType tile)
 {
-	ListNode<Map>* currentNode = (ListNode<Map>*)allocator.getNext();
-	new(currentNode) ListNode<Map>{ currentState, currentPath };
-	currentNode->data.emptyPos = newPos;
-	currentNode->data.tiles[oldPos] = currentNode->data.tiles[currentNode->data.emptyPos];
-	currentNode->data.tiles[currentNode->data.emptyPos] = 0;
+	size_t index = 0u;
+	for (;; ++index)
+	{
+		if (goal.tiles[index] == tile) return index;
+	}
+}
 
-	if (expanded.find(&currentNode->data) != expanded.end())
+/*
+* Calculates the extra moves needed by the tiles in one row or column that are in their goal line but in the wrong order.
+* Every tile that isn't part of the longest run of tiles already in goal order has to leave the line and come back which takes two moves.
+* The tiles at swapPos1 and swapPos2 are read as if they were swapped so the line can be checked as it was before a move.
+*/
+template<class Map, class Goal>
+unsigned int lineConflicts(const Map& state, const Goal& goal, size_t line, bool isRow, size_t swapPos1, size_t swapPos2)
+{
+	constexpr size_t width = Map::width, height = Map::height;
+	constexpr size_t maxLineLength = width > height ? width : height;
+	const size_t lineLength = isRow ? width : height;
+	const size_t step = isRow ? 1u : width;
+	size_t goalIndices[maxLineLength];
+	size_t tilesInLine = 0u;
+	for (size_t i = 0u, pos = isRow ? line * width : line; i != lineLength; ++i, pos += step)
 	{
-		currentNode->~ListNode<Map>();
-		allocator.replaceLast();
-		++numOfAttemptedNodeReExpansions;
+		const size_t readPos = pos == swapPos1 ? swapPos2 : pos == swapPos2 ? swapPos1 : pos;
+		const auto tile = state.tiles[readPos];
+		if (tile == 0) continue;
+		const size_t goalPos = goalPosition(goal, tile);
+		if ((isRow ? goalPos / width : goalPos % width) != line) continue;
+		goalIndices[tilesInLine] = isRow ? goalPos % width : goalPos / width;
+		++tilesInLine;
 	}
-	else
-	{	
-		calculateHeuristic<useManhattanDistance>(currentNode, currentState, goal, oldPos, newPos);
 
-#ifdef USE_HASH_MAP
-		auto elementInQueue = queueLookup.find(currentNode);
-		if (elementInQueue != queueLookup.end())
+	size_t longestRunEndingAt[maxLineLength];
+	size_t longestRun = 0u;
+	for (size_t i = 0u; i != tilesInLine; ++i)
+	{
+		longestRunEndingAt[i] = 1u;
+		for (size_t j = 0u; j != i; ++j)
 		{
-			auto element = (*elementInQueue);
-			if (element->data.f > currentNode->data.f)
+			if (goalIndices[j] < goalIndices[i] && longestRunEndingAt[j] + 1u > longestRunEndingAt[i])
 			{
-				element->data.f = currentNode->data.f;
-				element->data.g = currentNode->data.g;
-				element->next = currentNode->next;
-				posiblePaths.priorityIncreased(*element->data.positionInQueue);
+				longestRunEndingAt[i] = longestRunEndingAt[j] + 1u;
 			}
-			
-
-			currentNode->~ListNode<Map>();
-			allocator.replaceLast();
-			++numOfDeletionsFromMiddleOfHeap;
-		}
-		else
-		{
-			posiblePaths.push(LocationTracker<ListNode<Map>*>{currentNode});
-			queueLookup.insert(currentNode);
 		}
-#else
-		auto elementInQueue = posiblePaths.find(currentNode, ListNodeEqualityTester<Map>());
-		if (elementInQueue != posiblePaths.end())
-		{
-			auto element = *elementInQueue;
-			if (element->data.f > currentNode->data.f)
-			{
-				element->data.f = currentNode->data.f;
-				element->data.g = currentNode->data.g;
-				element->next = currentNode->next;
-				posiblePaths.priorityIncreased(*elementInQueue);
-			}
+		if (longestRunEndingAt[i] > longestRun) longestRun = longestRunEndingAt[i];
+	}
+	return (unsigned int)(2u * (tilesInLine - longestRun));
+}
+
+/*
+* Calculates the sum of manhattan distance plus linear conflicts based on the previous sum and the move taken.
+* A move can only change the order of tiles in the two lines the tile moves across, so only those lines are recalculated.
+*/
+template<heuristicFunction heuristic, class Node, class Map, class Goal>
+typename std::enable_if<heuristic == linearConflict, void>::type calculateHeuristic(Node* currentNode, Map& currentState, Goal& goal, unsigned int oldPos, unsigned int newPos)
+{
+	constexpr size_t width = Map::width;
+	calculateHeuristic<manhattanDistance>(currentNode, currentState, goal, oldPos, newPos);
 
+	//The moved tile is now at oldPos
+	const bool horizontalMove = oldPos / width == newPos / width;
+	const size_t oldLine = horizontalMove ? oldPos % width : oldPos / width;
+	const size_t newLine = horizontalMove ? newPos % width : newPos / width;
+	unsigned int conflictsAfter = lineConflicts(currentNode->data, goal, oldLine, !horizontalMove, oldPos, oldPos) +
+		lineConflicts(currentNode->data, goal, newLine, !horizontalMove, oldPos, oldPos);
+	unsigned int conflictsBefore = lineConflicts(currentNode->data, goal, oldLine, !horizontalMove, oldPos, newPos) +
+		lineConflicts(currentNode->data, goal, newLine, !horizontalMove, oldPos, newPos);
 
-			currentNode->~ListNode<Map>();
-			allocator.replaceLast();
-			++numOfDeletionsFromMiddleOfHeap;
-		}
-		else
-		{
-			posiblePaths.push(currentNode);
-		}
-#endif
-	}
+	currentNode->data.f += conflictsAfter - conflictsBefore;
+	currentNode->data.g += conflictsAfter - conflictsBefore;
 }
 
+/*
+* Calculates the sum of the row and column walking distances based on the previous sum and the move taken.
+* A move changes the row pattern if the empty tile moves up or down and the column pattern if it moves left or right.
+*/
+template<heuristicFunction heuristic, class Node, class Map, class Goal>
+typename std::enable_if<heuristic == walkingDistance, void>::type calculateHeuristic(Node* currentNode, Map& currentState, Goal& goal, unsigned int oldPos, unsigned int newPos)
+{
+	constexpr size_t width = Map::width, height = Map::height;
+	const auto& rows = getWalkingDistanceTable<height, width>(goal.emptyPos / width);
+	const auto& columns = getWalkingDistanceTable<width, height>(goal.emptyPos % width);
 
-template<bool useManhattanDistance>
-string aStar_ExpandedList(string const& initialState, string const& goalState, int &numOfStateExpansions, int& maxQLength, float &actualRunningTime,
-	int &numOfDeletionsFromMiddleOfHeap, int &numOfLocalLoopsAvoided, int &numOfAttemptedNodeReExpansions)
+	//The moved tile is now at oldPos
+	const size_t goalPos = goalPosition(goal, currentNode->data.tiles[oldPos]);
+	const size_t direction = newPos > oldPos ? 1u : 0u;
+	const unsigned int oldRowPattern = currentState.rowPattern;
+	const unsigned int oldColumnPattern = currentState.columnPattern;
+	unsigned int rowPattern = oldRowPattern;
+	unsigned int columnPattern = oldColumnPattern;
+	if (oldPos / width == newPos / width)
+	{
+		columnPattern = columns.next(oldColumnPattern, direction, goalPos % width);
+	}
+	else
+	{
+		rowPattern = rows.next(oldRowPattern, direction, goalPos / width);
+	}
+
+	unsigned int g2 = currentState.g + rows.distance(rowPattern) + columns.distance(columnPattern) -
+		rows.distance(oldRowPattern) - columns.distance(oldColumnPattern);
+
+	currentNode->data.f = currentState.f - currentState.g + 1u + g2;
+	currentNode->data.g = g2;
+	currentNode->data.rowPattern = rowPattern;
+	currentNode->data.columnPattern = columnPattern;
+}
+
+/*
+* The pattern databases for one goal. The tiles are split into groups of patternDatabaseTileCount in the order of their goal positions.
+*/
+template<size_t width, size_t height>
+struct PatternDatabaseSet
 {
-	string path;
-	clock_t startTime;
+	constexpr static size_t tileCount = width * height;
+	constexpr static size_t count = (tileCount - 1u + patternDatabaseTileCount - 1u) / patternDatabaseTileCount;
+	static_assert(count <= maxPatternDatabaseCount, "Too many pattern databases for HeuristicState<patternDatabase>");
 
-	constexpr size_t width = 3, height = 3;
-	using Map_t = MapWithHuristic<width, height>;
 	Map<width, height> goal;
+	std::unique_ptr<PatternDatabase<width, height, Mod3Packing>> databases[count];
+
+	/*
+	* If the PUZZLE_TABLE_DIR environment variable is set, databases are mapped from table files in that directory and any that are
+	* missing are built and saved there.
+	*/
+	explicit PatternDatabaseSet(const Map<width, height>& goal) : goal(goal)
+	{
+		const char* tableDirectory = std::getenv("PUZZLE_TABLE_DIR");
+		unsigned char tiles[tileCount];
+		size_t tilesFound = 0u;
+		for (size_t pos = 0u; pos != tileCount; ++pos)
+		{
+			if (goal.tiles[pos] == 0) continue;
+			tiles[tilesFound] = (unsigned char)goal.tiles[pos];
+			++tilesFound;
+		}
+		for (size_t i = 0u; i != count; ++i)
+		{
+			const size_t first = i * patternDatabaseTileCount;
+			const size_t size = tilesFound - first < patternDatabaseTileCount ? tilesFound - first : patternDatabaseTileCount;
+			if (tableDirectory != nullptr && *tableDirectory != '\0')
+			{
+				databases[i].reset(new PatternDatabase<width, height, Mod3Packing>(goal, tiles + first, size,
+					patternDatabasePath<width, height>(tableDirectory, goal, tiles + first, size)));
+			}
+			else
+			{
+				databases[i].reset(new PatternDatabase<width, height, Mod3Packing>(goal, tiles + first, size));
+			}
+		}
+	}
+};
+
+/*
+* Builds the pattern databases the first time they are needed for a goal and keeps the most recently used sets for later searches.
+* Each thread holds the last set it used so finding it again doesn't need the lock, which also keeps the set alive while the search
+* running on that thread uses it even after the cache has dropped it.
+*/
+template<size_t width, size_t height>
+const PatternDatabaseSet<width, height>& getPatternDatabases(const Map<width, height>& goal)
+{
+	thread_local std::shared_ptr<const PatternDatabaseSet<width, height>> lastUsed;
+	if (lastUsed != nullptr && lastUsed->goal == goal) return *lastUsed;
+
+	static TableCache<Map<width, height>, PatternDatabaseSet<width, height>, tableCacheCapacity> cache;
+	lastUsed = cache.get(goal, [&goal]() { return new PatternDatabaseSet<width, height>(goal); });
+	return *lastUsed;
+}
+
+/*
+* Packs the tiles four bits each so a state can be stored in a TranspositionTable or a Perimeter.
+*/
+template<class Map>
+static uint64_t packState(const Map& state)
+{
+	constexpr size_t tileCount = Map::width * Map::height;
+	static_assert(tileCount <= 16u, "Only boards with up to 16 tiles fit in 64 bits");
+	uint64_t key = 0u;
+	for (size_t i = 0u; i != tileCount; ++i)
+	{
+		key = (key << 4u) | (uint64_t)state.tiles[i];
+	}
+	return key;
+}
+
+/*
+* Rebuilds a state from the key packState made for it.
+*/
+template<class Map>
+static void unpackState(uint64_t key, Map& state)
+{
+	constexpr size_t tileCount = Map::width * Map::height;
+	for (size_t i = tileCount; i-- != 0u;)
+	{
+		state.tiles[i] = (char)(key & 15u);
+		if (state.tiles[i] == 0) state.emptyPos = i;
+		key >>= 4u;
+	}
+}
+
+/*
+* A state on the perimeter and its exact distance to the goal.
+*/
+struct PerimeterEntry
+{
+	uint64_t key;
+	unsigned int distance;
+};
+
+/*
+* Hashes and compares table entries by the packed state stored in their key.
+*/
+template<class Entry>
+struct PackedStateHasher
+{
+	size_t operator()(const Entry& value) const
+	{
+		return (size_t)((value.key * 0x9E3779B97F4A7C15u) >> 32u);
+	}
+};
+
+template<class Entry>
+struct PackedStateEqualityTester
+{
+	constexpr bool operator()(const Entry& value1, const Entry& value2) const
+	{
+		return value1.key == value2.key;
+	}
+};
+
+/*
+* Every state at most depth moves from the goal with its exact distance, found by a breadth-first search backwards from the goal.
+* A search that reaches the perimeter knows the rest of the solution so it can stop there instead of searching the last depth moves.
+*/
+template<size_t width, size_t height>
+class Perimeter
+{
+	HashMap<PerimeterEntry, PackedStateHasher<PerimeterEntry>, PackedStateEqualityTester<PerimeterEntry>> states;
+public:
+	constexpr static unsigned int outside = std::numeric_limits<unsigned int>::max();
+	const Map<width, height> goal;
+	const unsigned int depth;
+
+	Perimeter(const Map<width, height>& goal, unsigned int depth) : goal(goal), depth(depth)
+	{
+		//Each level of the search is stored after the previous one so levelStart to levelEnd is the level being expanded
+		Vector<Map<width, height>> levels;
+		levels.push_back(goal);
+		states.insert(PerimeterEntry{ packState(goal), 0u });
+		size_t levelStart = 0u;
+		for (unsigned int distance = 1u; distance <= depth && levelStart != levels.size(); ++distance)
+		{
+			const size_t levelEnd = levels.size();
+			for (size_t i = levelStart; i != levelEnd; ++i)
+			{
+				const size_t emptyPos = levels[i].emptyPos;
+				const size_t newPositions[4] = { emptyPos - width, emptyPos + 1u, emptyPos + width, emptyPos - 1u };
+				const bool canMove[4] = { emptyPos / width != 0u, emptyPos % width != width - 1u, emptyPos / width != height - 1u, emptyPos % width != 0u };
+				for (size_t direction = 0u; direction != 4u; ++direction)
+				{
+					if (!canMove[direction]) continue;
+					Map<width, height> child = levels[i];
+					child.tiles[emptyPos] = child.tiles[newPositions[direction]];
+					child.tiles[newPositions[direction]] = 0;
+					child.emptyPos = newPositions[direction];
+					const PerimeterEntry entry{ packState(child), distance };
+					if (states.find(entry) != states.end()) continue;
+					states.insert(entry);
+					levels.push_back(child);
+				}
+			}
+			levelStart = levelEnd;
+		}
+	}
+
+	size_t size() const
+	{
+		return states.size();
+	}
+
+	/*
+	* Returns the exact distance from state to the goal or outside if state isn't on the perimeter.
+	*/
+	unsigned int distance(const Map<width, height>& state) const
+	{
+		auto entry = states.find(PerimeterEntry{ packState(state), 0u });
+		return entry != states.end() ? (*entry).distance : outside;
+	}
+
+	/*
+	* Adds the moves from a state on the perimeter to the goal onto the end of path.
+	*/
+	void appendPath(Map<width, height> state, std::string& path) const
+	{
+		const char moves[4] = { 'U', 'R', 'D', 'L' };
+		for (unsigned int remaining = distance(state); remaining != 0u; --remaining)
+		{
+			const size_t emptyPos = state.emptyPos;
+			const size_t newPositions[4] = { emptyPos - width, emptyPos + 1u, emptyPos + width, emptyPos - 1u };
+			const bool canMove[4] = { emptyPos / width != 0u, emptyPos % width != width - 1u, emptyPos / width != height - 1u, emptyPos % width != 0u };
+			for (size_t direction = 0u; direction != 4u; ++direction)
+			{
+				if (!canMove[direction]) continue;
+				state.tiles[emptyPos] = state.tiles[newPositions[direction]];
+				state.tiles[newPositions[direction]] = 0;
+				state.emptyPos = newPositions[direction];
+				if (distance(state) == remaining - 1u)
+				{
+					path.push_back(moves[direction]);
+					break;
+				}
+				state.tiles[newPositions[direction]] = state.tiles[emptyPos];
+				state.tiles[emptyPos] = 0;
+				state.emptyPos = emptyPos;
+			}
+		}
+	}
+};
+
+/*
+* Builds the perimeter the first time it is needed for a goal and depth, so a batch of puzzles with the same goal only builds it once.
+* The most recently used perimeters are kept so threads solving puzzles with the same goal share them, and a search holds on to the
+* one it uses so it isn't freed while the search runs.
+*/
+template<size_t width, size_t height>
+std::shared_ptr<const Perimeter<width, height>> getPerimeter(const Map<width, height>& goal, unsigned int depth)
+{
+	static TableCache<std::pair<Map<width, height>, unsigned int>, Perimeter<width, height>, tableCacheCapacity> cache;
+	return cache.get(std::make_pair(goal, depth), [&goal, depth]() { return new Perimeter<width, height>(goal, depth); });
+}
+
+/*
+* Calculates the largest distance from the pattern databases based on the exact distances of the previous state.
+*/
+template<heuristicFunction heuristic, class Node, class Map, class Goal>
+typename std::enable_if<heuristic == patternDatabase, void>::type calculateHeuristic(Node* currentNode, Map& currentState, Goal& goal, unsigned int /*oldPos*/, unsigned int /*newPos*/)
+{
+	const auto& databases = getPatternDatabases(goal);
+	unsigned char distances[maxPatternDatabaseCount];
+	unsigned int oldDistance = 0u;
+	unsigned int newDistance = 0u;
+	for (size_t i = 0u; i != databases.count; ++i)
+	{
+		const unsigned int parentDistance = currentState.patternDatabaseDistances[i];
+		distances[i] = (unsigned char)databases.databases[i]->distance(currentNode->data, parentDistance);
+		if (parentDistance > oldDistance) oldDistance = parentDistance;
+		if (distances[i] > newDistance) newDistance = distances[i];
+	}
+
+	unsigned int g2 = currentState.g + newDistance - oldDistance;
+
+	currentNode->data.f = currentState.f - currentState.g + 1u + g2;
+	currentNode->data.g = g2;
+	for (size_t i = 0u; i != databases.count; ++i)
+	{
+		currentNode->data.patternDatabaseDistances[i] = distances[i];
+	}
+}
+
+/*
+* Calculates the larger of the pattern database distances of a state and of its dual. Duals are only looked up when the empty tile is in
+* its goal position so neighbouring values can differ by more than one move and searches have to use pathmax.
+*/
+template<heuristicFunction heuristic, class Node, class Map, class Goal>
+typename std::enable_if<heuristic == dualPatternDatabase, void>::type calculateHeuristic(Node* currentNode, Map& currentState, Goal& goal, unsigned int /*oldPos*/, unsigned int newPos)
+{
+	const auto& databases = getPatternDatabases(goal);
+	unsigned char distances[maxPatternDatabaseCount];
+	unsigned int oldDistance = currentState.dualDistance;
+	unsigned int newDistance = 0u;
+	for (size_t i = 0u; i != databases.count; ++i)
+	{
+		const unsigned int parentDistance = currentState.patternDatabaseDistances[i];
+		distances[i] = (unsigned char)databases.databases[i]->distance(currentNode->data, parentDistance);
+		if (parentDistance > oldDistance) oldDistance = parentDistance;
+		if (distances[i] > newDistance) newDistance = distances[i];
+	}
+	unsigned int dualDistance = 0u;
+	if (newPos == goal.emptyPos)
+	{
+		for (size_t i = 0u; i != databases.count; ++i)
+		{
+			const unsigned int distance = databases.databases[i]->dualDistance(currentNode->data);
+			if (distance > dualDistance) dualDistance = distance;
+		}
+	}
+	if (dualDistance > newDistance) newDistance = dualDistance;
+
+	unsigned int g2 = currentState.g - currentState.pathmaxRaise + newDistance - oldDistance;
+
+	currentNode->data.f = currentState.f - currentState.g + 1u + g2;
+	currentNode->data.g = g2;
+	for (size_t i = 0u; i != databases.count; ++i)
+	{
+		currentNode->data.patternDatabaseDistances[i] = distances[i];
+	}
+	currentNode->data.dualDistance = (unsigned char)dualDistance;
+	currentNode->data.pathmaxRaise = 0u;
+}
+
+/*
+* Raises the f value of a state to at least f. Values are compared as differences so f values of states whose heuristic value is below
+* that of the initial state still compare correctly.
+*/
+template<class Map>
+void pathmax(Map& state, unsigned int f)
+{
+	if ((int)(f - state.f) <= 0) return;
+	const unsigned int raise = f - state.f;
+	state.f += raise;
+	state.g += raise;
+	recordPathmaxRaise(state, raise);
+}
+
+/*
+* Sets up anything the heuristic needs to know about the initial state before calculateHeuristic can be used on its children.
+*/
+template<heuristicFunction heuristic, class Map, class Goal>
+typename std::enable_if<heuristic != walkingDistance && heuristic != patternDatabase && heuristic != dualPatternDatabase, void>::type
+	initializeHeuristic(Map& /*state*/, Goal& /*goal*/) {}
+
+/*
+* Finds the exact pattern database distances of the initial state. Building the databases for a new goal happens here rather than during
+* the search.
+*/
+template<heuristicFunction heuristic, class Map, class Goal>
+typename std::enable_if<heuristic == patternDatabase, void>::type initializeHeuristic(Map& state, Goal& goal)
+{
+	const auto& databases = getPatternDatabases(goal);
+	for (size_t i = 0u; i != databases.count; ++i)
+	{
+		state.patternDatabaseDistances[i] = (unsigned char)databases.databases[i]->distance(state);
+	}
+}
+
+/*
+* Finds the exact pattern database distances of the initial state and of its dual if the empty tile is in its goal position.
+*/
+template<heuristicFunction heuristic, class Map, class Goal>
+typename std::enable_if<heuristic == dualPatternDatabase, void>::type initializeHeuristic(Map& state, Goal& goal)
+{
+	initializeHeuristic<patternDatabase>(state, goal);
+	const auto& databases = getPatternDatabases(goal);
+	state.dualDistance = 0u;
+	state.pathmaxRaise = 0u;
+	if (state.emptyPos != goal.emptyPos) return;
+	for (size_t i = 0u; i != databases.count; ++i)
+	{
+		const unsigned int distance = databases.databases[i]->dualDistance(state);
+		if (distance > state.dualDistance) state.dualDistance = (unsigned char)distance;
+	}
+}
+
+/*
+* Finds the walking distance patterns of the initial state. Building the tables for a new goal happens here rather than during the search.
+*/
+template<heuristicFunction heuristic, class Map, class Goal>
+typename std::enable_if<heuristic == walkingDistance, void>::type initializeHeuristic(Map& state, Goal& goal)
+{
+	constexpr size_t width = Map::width, height = Map::height;
+	using Rows = WalkingDistanceTable<height, width>;
+	using Columns = WalkingDistanceTable<width, height>;
+	const Rows& rows = getWalkingDistanceTable<height, width>(goal.emptyPos / width);
+	const Columns& columns = getWalkingDistanceTable<width, height>(goal.emptyPos % width);
+	uint64_t rowPattern = 0u;
+	uint64_t columnPattern = 0u;
+	for (size_t pos = 0u; pos != width * height; ++pos)
+	{
+		if (state.tiles[pos] == 0) continue;
+		const size_t goalPos = goalPosition(goal, state.tiles[pos]);
+		rowPattern = Rows::addTile(rowPattern, pos / width, goalPos / width);
+		columnPattern = Columns::addTile(columnPattern, pos % width, goalPos % width);
+	}
+	state.rowPattern = rows.find(rowPattern);
+	state.columnPattern = columns.find(columnPattern);
+}
+
+/*
+* The value of a heuristic for a state calculated from scratch. Searches normally only keep track of how far the value has moved from the
+* value of the initial state, but the values of different heuristics can only be compared from scratch. Heuristics with tables need
+* initializeHeuristic to have been called on the state first.
+*/
+template<heuristicFunction heuristic, class Map, class Goal>
+typename std::enable_if<heuristic == misplacedTiles, unsigned int>::type heuristicValue(const Map& state, const Goal& goal)
+{
+	unsigned int misplaced = 0u;
+	for (size_t pos = 0u; pos != Map::width * Map::height; ++pos)
+	{
+		if (state.tiles[pos] != 0 && state.tiles[pos] != goal.tiles[pos]) ++misplaced;
+	}
+	return misplaced;
+}
+
+template<heuristicFunction heuristic, class Map, class Goal>
+typename std::enable_if<heuristic == manhattanDistance, unsigned int>::type heuristicValue(const Map& state, const Goal& goal)
+{
+	constexpr size_t width = Map::width;
+	unsigned int distance = 0u;
+	for (size_t pos = 0u; pos != Map::width * Map::height; ++pos)
+	{
+		if (state.tiles[pos] == 0) continue;
+		const size_t goalPos = goalPosition(goal, state.tiles[pos]);
+		distance += (unsigned int)((pos % width > goalPos % width ? pos % width - goalPos % width : goalPos % width - pos % width) +
+			(pos / width > goalPos / width ? pos / width - goalPos / width : goalPos / width - pos / width));
+	}
+	return distance;
+}
+
+template<heuristicFunction heuristic, class Map, class Goal>
+typename std::enable_if<heuristic == linearConflict, unsigned int>::type heuristicValue(const Map& state, const Goal& goal)
+{
+	unsigned int distance = heuristicValue<manhattanDistance>(state, goal);
+	for (size_t row = 0u; row != Map::height; ++row)
+	{
+		distance += lineConflicts(state, goal, row, true, 0u, 0u);
+	}
+	for (size_t column = 0u; column != Map::width; ++column)
+	{
+		distance += lineConflicts(state, goal, column, false, 0u, 0u);
+	}
+	return distance;
+}
+
+template<heuristicFunction heuristic, class Map, class Goal>
+typename std::enable_if<heuristic == walkingDistance, unsigned int>::type heuristicValue(const Map& state, const Goal& goal)
+{
+	constexpr size_t width = Map::width, height = Map::height;
+	return getWalkingDistanceTable<height, width>(goal.emptyPos / width).distance(state.rowPattern) +
+		getWalkingDistanceTable<width, height>(goal.emptyPos % width).distance(state.columnPattern);
+}
+
+template<heuristicFunction heuristic, class Map, class Goal>
+typename std::enable_if<heuristic == patternDatabase, unsigned int>::type heuristicValue(const Map& state, const Goal& goal)
+{
+	const auto& databases = getPatternDatabases(goal);
+	unsigned int distance = 0u;
+	for (size_t i = 0u; i != databases.count; ++i)
+	{
+		if (state.patternDatabaseDistances[i] > distance) distance = state.patternDatabaseDistances[i];
+	}
+	return distance;
+}
+
+template<heuristicFunction heuristic, class Map, class Goal>
+typename std::enable_if<heuristic == dualPatternDatabase, unsigned int>::type heuristicValue(const Map& state, const Goal& goal)
+{
+	const unsigned int distance = heuristicValue<patternDatabase>(state, goal);
+	return state.dualDistance > distance ? state.dualDistance : distance;
+}
+
+/*
+* Raises the f value of a state on the perimeter to use its exact distance to the goal in place of its heuristic value.
+* initialHeuristic is the heuristic value of the initial state that f values are relative to.
+* Returns false if the state isn't on the perimeter.
+*/
+template<class Map>
+bool usePerimeterDistance(Map& state, const Perimeter<Map::width, Map::height>& perimeter, unsigned int initialHeuristic)
+{
+	const unsigned int distance = perimeter.distance(state);
+	if (distance == Perimeter<Map::width, Map::height>::outside) return false;
+	//The number of moves to a state is f - g
+	pathmax(state, state.f - state.g + distance - initialHeuristic);
+	return true;
+}
+
+template<heuristicFunction heuristic, class Queue, class Expanded, class Map, class Map2, class Allocator
 #ifdef USE_HASH_MAP
-	using QueueElement = LocationTracker<ListNode<Map_t>*>;
-	using QueueType = PriorityQueue<QueueElement, Vector<QueueElement>, GreaterHeuisticTracker<Map_t>>;
+	, class QueueLookup
+#endif
+	>
+void expandAStarExpanded(const Map& currentState, ListNode<Map>* currentPath, size_t newPos, size_t oldPos, Queue& posiblePaths,
+	Expanded& expanded, const Map2& goal, Allocator& allocator, int& numOfDeletionsFromMiddleOfHeap, int& numOfAttemptedNodeReExpansions,
+	const Perimeter<Map::width, Map::height>* perimeter, unsigned int initialHeuristic
+#ifdef USE_HASH_MAP
+	, QueueLookup& queueLookup
+#endif
+	)
+{
+	ListNode<Map>* currentNode = (ListNode<Map>*)allocator.getNext();
+	new(currentNode) ListNode<Map>{ currentState, currentPath };
+	currentNode->data.emptyPos = newPos;
+	currentNode->data.tiles[oldPos] = currentNode->data.tiles[currentNode->data.emptyPos];
+	currentNode->data.tiles[currentNode->data.emptyPos] = 0;
+
+	//The number of moves to a state is f - g
+	auto existing = expanded.find(&currentNode->data);
+	if (existing != expanded.end() && (isConsistent(heuristic) || (*existing)->f - (*existing)->g <= currentState.f - currentState.g + 1u))
+	{
+		currentNode->~ListNode<Map>();
+		allocator.replaceLast();
+		++numOfAttemptedNodeReExpansions;
+	}
+	else
+	{	
+		calculateHeuristic<heuristic>(currentNode, currentState, goal, oldPos, newPos);
+		if (!isConsistent(heuristic)) pathmax(currentNode->data, currentState.f);
+		//States on the perimeter are never expanded so their exact f value can't make the heuristic inconsistent
+		if (perimeter != nullptr) usePerimeterDistance(currentNode->data, *perimeter, initialHeuristic);
+
+#ifdef USE_HASH_MAP
+		auto elementInQueue = queueLookup.find(currentNode);
+		if (elementInQueue != queueLookup.end())
+		{
+			auto element = (*elementInQueue);
+			if (element->data.f > currentNode->data.f)
+			{
+				element->data.f = currentNode->data.f;
+				element->data.g = currentNode->data.g;
+				static_cast<HeuristicState<heuristic>&>(element->data) = currentNode->data;
+				element->next = currentNode->next;
+				posiblePaths.priorityIncreased(*element->data.positionInQueue);
+			}
+			
+
+			currentNode->~ListNode<Map>();
+			allocator.replaceLast();
+			++numOfDeletionsFromMiddleOfHeap;
+			currentNode = element;
+		}
+		else
+		{
+			posiblePaths.push(LocationTracker<ListNode<Map>*>{currentNode});
+			queueLookup.insert(currentNode);
+		}
 #else
-	using QueueType = PriorityQueue<ListNode<Map_t>*, Vector<ListNode<Map_t>*>, GreaterHeuistic<Map_t>>;
+		auto elementInQueue = posiblePaths.find(currentNode, ListNodeEqualityTester<Map>());
+		if (elementInQueue != posiblePaths.end())
+		{
+			auto element = *elementInQueue;
+			if (element->data.f > currentNode->data.f)
+			{
+				element->data.f = currentNode->data.f;
+				element->data.g = currentNode->data.g;
+				static_cast<HeuristicState<heuristic>&>(element->data) = currentNode->data;
+				element->next = currentNode->next;
+				posiblePaths.priorityIncreased(*elementInQueue);
+			}
+
+
+			currentNode->~ListNode<Map>();
+			allocator.replaceLast();
+			++numOfDeletionsFromMiddleOfHeap;
+			currentNode = element;
+		}
+		else
+		{
+			posiblePaths.push(currentNode);
+		}
 #endif
-	QueueType posiblePaths;
-	VisitedList<Map_t*, Hasher<Map_t>, EqualityTester<Map_t>> expanded;
+		//With an inconsistent heuristic a state can be expanded before the shortest path to it is found so it has to be expanded again
+		if (existing != expanded.end()) *existing = &currentNode->data;
+	}
+}
+
+
+template<heuristicFunction heuristic>
+string aStar_ExpandedList(string const& initialState, string const& goalState, int &numOfStateExpansions, int& maxQLength, float &actualRunningTime,
+	int &numOfDeletionsFromMiddleOfHeap, int &numOfLocalLoopsAvoided, int &numOfAttemptedNodeReExpansions, unsigned int perimeterDepth,
+	const CancellationToken* cancellation)
+{
+	string path;
+	clock_t startTime;
+
+	constexpr size_t width = 3, height = 3;
+	using Map_t = MapWithHuristic<width, height, char, heuristic>;
+	Map<width, height> goal;
+#ifdef USE_HASH_MAP
+	using QueueElement = LocationTracker<ListNode<Map_t>*>;
+	using QueueType = PriorityQueue<QueueElement, Vector<QueueElement>, GreaterHeuisticTracker<Map_t>>;
+#else
+	using QueueType = PriorityQueue<ListNode<Map_t>*, Vector<ListNode<Map_t>*>, GreaterHeuistic<Map_t>>;
+#endif
+	QueueType posiblePaths;
+	VisitedList<Map_t*, Hasher<Map_t>, EqualityTester<Map_t>> expanded;
+	ListNode<Map_t>* currentNode;
+	StackSlabAllocator<sizeof(ListNode<Map_t>), alignof(ListNode<Map_t>), (sizeof(ListNode<Map_t>) + sizeof(void*) > 204u ? 20u :
+		(4096u - sizeof(void*)) / sizeof(ListNode<Map_t>) * sizeof(ListNode<Map_t>))> allocator;
+
+#ifdef USE_HASH_MAP
+	HashMap<ListNode<Map_t>*, ListNodeHasher<Map_t, 10>, ListNodeEqualityTester<Map_t>> queueLookup;
+#endif
+
+	numOfDeletionsFromMiddleOfHeap = 0;
+	numOfLocalLoopsAvoided = 0;
+	numOfAttemptedNodeReExpansions = 0;
+	numOfStateExpansions = 0;
+
+
+	// cout << "------------------------------" << endl;
+	// cout << "<<aStar_ExpandedList>>" << endl;
+	// cout << "------------------------------" << endl;
+	
+	startTime = clock();
+
+	try
+	{
+
+		for (size_t i = 0; i != goalState.size(); ++i)
+		{
+			if (goalState[i] == '0')
+			{
+				goal.tiles[i] = 0;
+				goal.emptyPos = i;
+			}
+			else
+			{
+				goal.tiles[i] = goalState[i] - '0';
+			}
+		}
+
+		currentNode = (ListNode<Map_t>*)allocator.getNext();
+		new(currentNode) ListNode<Map_t>{ Map_t(), nullptr };
+		for (size_t i = 0; i != initialState.size(); ++i)
+		{
+			if (initialState[i] == '0')
+			{
+				currentNode->data.tiles[i] = 0;
+				currentNode->data.emptyPos = i;
+			}
+			else
+			{
+				currentNode->data.tiles[i] = initialState[i] - '0';
+			}
+		}
+
+		initializeHeuristic<heuristic>(currentNode->data, goal);
+		const std::shared_ptr<const Perimeter<width, height>> heldPerimeter = perimeterDepth != 0u ? getPerimeter(goal, perimeterDepth) : nullptr;
+		const Perimeter<width, height>* perimeter = heldPerimeter.get();
+		const unsigned int initialHeuristic = perimeter != nullptr ? heuristicValue<heuristic>(currentNode->data, goal) : 0u;
+		if (perimeter != nullptr) usePerimeterDistance(currentNode->data, *perimeter, initialHeuristic);
+
+		
+#ifdef USE_HASH_MAP
+		posiblePaths.push(QueueElement{ currentNode });
+		queueLookup.insert(posiblePaths.top().data);
+#else
+		posiblePaths.push(currentNode);
+#endif
+		maxQLength = 1;
+		bool goalFound = false;
+		bool cancelled = false;
+
+		while (!posiblePaths.empty())
+		{
+			if (shouldStop(cancellation, numOfStateExpansions))
+			{
+				cancelled = true;
+				break;
+			}
+			
+#ifdef USE_HASH_MAP
+			ListNode<Map_t>* currentPath = posiblePaths.top().data;
+			queueLookup.erase(currentPath);
+#else
+			ListNode<Map_t>* currentPath = posiblePaths.top();
+#endif
+			//A state on the perimeter has its exact f value so the rest of the solution is the shortest path from it to the goal
+			if (perimeter != nullptr ? perimeter->distance(currentPath->data) != Perimeter<width, height>::outside : currentPath->data == goal)
+			{
+				goalFound = true;
+				break;
+			}
+			posiblePaths.pop();
+			Map_t& currentState = currentPath->data;
+
+			//expand path
+			size_t emptyPos = currentState.emptyPos;
+			size_t x = emptyPos % width;
+			size_t y = emptyPos / width;
+			//Moving the empty tile back to where it just came from would only recreate the parent state
+			size_t parentPos = currentPath->next != nullptr ? currentPath->next->data.emptyPos : width * height;
+			if (y != 0u && emptyPos - width != parentPos)
+			{
+#ifdef USE_HASH_MAP
+				expandAStarExpanded<heuristic>(currentState, currentPath, emptyPos - width, emptyPos, posiblePaths,
+					expanded, goal, allocator, numOfDeletionsFromMiddleOfHeap, numOfAttemptedNodeReExpansions, perimeter, initialHeuristic, queueLookup);
+#else
+				expandAStarExpanded<heuristic>(currentState, currentPath, emptyPos - width, emptyPos, posiblePaths,
+					expanded, goal, allocator, numOfDeletionsFromMiddleOfHeap, numOfAttemptedNodeReExpansions, perimeter, initialHeuristic);
+#endif
+			}
+			if (x != width - 1u && emptyPos + 1u != parentPos)
+			{
+#ifdef USE_HASH_MAP
+				expandAStarExpanded<heuristic>(currentState, currentPath, emptyPos + 1u, emptyPos, posiblePaths,
+					expanded, goal, allocator, numOfDeletionsFromMiddleOfHeap, numOfAttemptedNodeReExpansions, perimeter, initialHeuristic, queueLookup);
+#else
+				expandAStarExpanded<heuristic>(currentState, currentPath, emptyPos + 1u, emptyPos, posiblePaths,
+					expanded, goal, allocator, numOfDeletionsFromMiddleOfHeap, numOfAttemptedNodeReExpansions, perimeter, initialHeuristic);
+#endif
+			}
+			if (y != height - 1u && emptyPos + width != parentPos)
+			{
+#ifdef USE_HASH_MAP
+				expandAStarExpanded<heuristic>(currentState, currentPath, emptyPos + width, emptyPos, posiblePaths,
+					expanded, goal, allocator, numOfDeletionsFromMiddleOfHeap, numOfAttemptedNodeReExpansions, perimeter, initialHeuristic, queueLookup);
+#else
+				expandAStarExpanded<heuristic>(currentState, currentPath, emptyPos + width, emptyPos, posiblePaths,
+					expanded, goal, allocator, numOfDeletionsFromMiddleOfHeap, numOfAttemptedNodeReExpansions, perimeter, initialHeuristic);
+#endif
+			}
+			if (x != 0u && emptyPos - 1u != parentPos)
+			{
+#ifdef USE_HASH_MAP
+				expandAStarExpanded<heuristic>(currentState, currentPath, emptyPos - 1u, emptyPos, posiblePaths,
+					expanded, goal, allocator, numOfDeletionsFromMiddleOfHeap, numOfAttemptedNodeReExpansions, perimeter, initialHeuristic, queueLookup);
+#else
+				expandAStarExpanded<heuristic>(currentState, currentPath, emptyPos - 1u, emptyPos, posiblePaths,
+					expanded, goal, allocator, numOfDeletionsFromMiddleOfHeap, numOfAttemptedNodeReExpansions, perimeter, initialHeuristic);
+#endif
+			}
+
+			if (currentPath->next != nullptr)
+			{
+				++numOfLocalLoopsAvoided;
+			}
+			if (posiblePaths.size() > (unsigned int)maxQLength)
+			{
+				maxQLength = (int)posiblePaths.size();
+			}
+			if (isConsistent(heuristic) || expanded.find(&currentState) == expanded.end()) expanded.insert(&currentState);
+			++numOfStateExpansions;
+		}
+
+		if (goalFound)
+		{
+#ifdef USE_HASH_MAP
+			path = packPath(posiblePaths.top().data);
+			if (perimeter != nullptr) perimeter->appendPath(posiblePaths.top().data->data, path);
+#else
+			path = packPath(posiblePaths.top());
+			if (perimeter != nullptr) perimeter->appendPath(posiblePaths.top()->data, path);
+#endif
+		}
+		else if (cancelled)
+		{
+			path = stoppedPath(cancellation);
+		}
+		else
+		{
+			path = "";
+		}
+
+	}
+	catch (std::bad_alloc)
+	{
+		path = "OOM";
+	}
+
+	actualRunningTime = ((float)(clock() - startTime) / CLOCKS_PER_SEC);
+
+	return path;
+}
+	
+
+string aStar_ExpandedList(string const& initialState, string const& goalState, int &numOfStateExpansions, int& maxQLength, float &actualRunningTime,
+	int &numOfDeletionsFromMiddleOfHeap, int &numOfLocalLoopsAvoided, int &numOfAttemptedNodeReExpansions, heuristicFunction heuristic, unsigned int perimeterDepth,
+	const CancellationToken* cancellation){
+											 
+	if (heuristic == heuristicFunction::manhattanDistance)
+	{
+		return aStar_ExpandedList<manhattanDistance>(initialState, goalState, numOfStateExpansions, maxQLength, actualRunningTime,
+			numOfDeletionsFromMiddleOfHeap, numOfLocalLoopsAvoided, numOfAttemptedNodeReExpansions, perimeterDepth, cancellation);
+	}
+	else if (heuristic == heuristicFunction::linearConflict)
+	{
+		return aStar_ExpandedList<linearConflict>(initialState, goalState, numOfStateExpansions, maxQLength, actualRunningTime,
+			numOfDeletionsFromMiddleOfHeap, numOfLocalLoopsAvoided, numOfAttemptedNodeReExpansions, perimeterDepth, cancellation);
+	}
+	else if (heuristic == heuristicFunction::walkingDistance)
+	{
+		return aStar_ExpandedList<walkingDistance>(initialState, goalState, numOfStateExpansions, maxQLength, actualRunningTime,
+			numOfDeletionsFromMiddleOfHeap, numOfLocalLoopsAvoided, numOfAttemptedNodeReExpansions, perimeterDepth, cancellation);
+	}
+	else if (heuristic == heuristicFunction::patternDatabase)
+	{
+		return aStar_ExpandedList<patternDatabase>(initialState, goalState, numOfStateExpansions, maxQLength, actualRunningTime,
+			numOfDeletionsFromMiddleOfHeap, numOfLocalLoopsAvoided, numOfAttemptedNodeReExpansions, perimeterDepth, cancellation);
+	}
+	else if (heuristic == heuristicFunction::dualPatternDatabase)
+	{
+		return aStar_ExpandedList<dualPatternDatabase>(initialState, goalState, numOfStateExpansions, maxQLength, actualRunningTime,
+			numOfDeletionsFromMiddleOfHeap, numOfLocalLoopsAvoided, numOfAttemptedNodeReExpansions, perimeterDepth, cancellation);
+	}
+	else
+	{
+		return aStar_ExpandedList<misplacedTiles>(initialState, goalState, numOfStateExpansions, maxQLength, actualRunningTime,
+			numOfDeletionsFromMiddleOfHeap, numOfLocalLoopsAvoided, numOfAttemptedNodeReExpansions, perimeterDepth, cancellation);
+	}
+}
+
+/*
+* Stores a state for hash distributed A* along with the link used to send it to the thread that owns it.
+*/
+template<size_t width, size_t height, heuristicFunction heuristic>
+struct MapWithMessageLink : MapWithHuristic<width, height, char, heuristic>
+{
+	ListNode<MapWithMessageLink>* nextMessage;
+	bool superseded;
+};
+
+struct NextMessage
+{
+	template<class Node>
+	Node*& operator()(Node* node) const
+	{
+		return node->data.nextMessage;
+	}
+};
+
+/*
+* Hash distributed A* (HDA*). Every thread owns an open list and a table of the best paths found to the states hashed to it.
+* Expanding a state sends each child to the thread that owns it through that thread's MessageQueue, so no table is ever shared.
+* f values are relative to the heuristic value of the initial state which every thread shares.
+* A goal found by one thread is only a bound on the cost of the solution: the search ends once every thread has nothing left with a
+* smaller f value and no messages are in flight. activeWork counts the threads that aren't idle plus the messages sent but not yet
+* received, so it can only reach 0 once neither can make more work.
+*/
+template<heuristicFunction heuristic>
+string hashDistributedAStar(string const& initialState, string const& goalState, int &numOfStateExpansions, int& maxQLength, float &actualRunningTime,
+	int &numOfDeletionsFromMiddleOfHeap, int &numOfLocalLoopsAvoided, int &numOfAttemptedNodeReExpansions, unsigned int threadCount,
+	const CancellationToken* cancellation)
+{
+	string path;
+
+	constexpr size_t width = 3, height = 3;
+	constexpr unsigned int infinity = std::numeric_limits<unsigned int>::max();
+	using Map_t = MapWithMessageLink<width, height, heuristic>;
+	using Node = ListNode<Map_t>;
+	using Allocator = ThreadSlabAllocator<sizeof(Node), alignof(Node)>;
+	using Inbox = MessageQueue<Node, NextMessage>;
+	Map<width, height> goal;
+
+	numOfDeletionsFromMiddleOfHeap = 0;
+	numOfLocalLoopsAvoided = 0;
+	numOfAttemptedNodeReExpansions = 0;
+	numOfStateExpansions = 0;
+	maxQLength = 1;
+	if (threadCount == 0u) threadCount = std::thread::hardware_concurrency();
+	if (threadCount == 0u) threadCount = 1u;
+
+	//Wall clock time because clock() adds up the time of every thread
+	const auto startTime = std::chrono::steady_clock::now();
+
+	try
+	{
+
+		for (size_t i = 0; i != goalState.size(); ++i)
+		{
+			if (goalState[i] == '0')
+			{
+				goal.tiles[i] = 0;
+				goal.emptyPos = i;
+			}
+			else
+			{
+				goal.tiles[i] = goalState[i] - '0';
+			}
+		}
+
+		//Nodes are allocated by the thread that generates them and released by the thread that owns them if it finds they aren't needed.
+		//The rest stay allocated until the pool is destructed because other threads hold pointers to them as parents.
+		typename Allocator::Pool pool;
+		Allocator initialAllocator(pool);
+		std::unique_ptr<Inbox[]> inboxes(new Inbox[threadCount]);
+
+		Node* initialNode = (Node*)initialAllocator.getNext();
+		new(initialNode) Node{ Map_t(), nullptr };
+		for (size_t i = 0; i != initialState.size(); ++i)
+		{
+			if (initialState[i] == '0')
+			{
+				initialNode->data.tiles[i] = 0;
+				initialNode->data.emptyPos = i;
+			}
+			else
+			{
+				initialNode->data.tiles[i] = initialState[i] - '0';
+			}
+		}
+		initializeHeuristic<heuristic>(initialNode->data, goal);
+		initialNode->data.superseded = false;
+
+		const ListNodeHasher<Map_t, 10> hasher{};
+		//Threads own states by different bits of the hash than their tables use to place them
+		auto owner = [&](const Node* node)
+		{
+			return (unsigned int)(((uint64_t)hasher(node) * 0x9E3779B97F4A7C15u >> 32u) % threadCount);
+		};
+
+		std::atomic<unsigned int> incumbentF(infinity);
+		Node* incumbent = nullptr;
+		std::mutex incumbentMutex;
+		std::atomic<long> activeWork((long)threadCount + 1);
+		std::atomic<bool> outOfMemory(false);
+		//Set by the first thread to find the token stopped so the rest stop too
+		std::atomic<bool> stopped(false);
+		std::atomic<unsigned int> nextThread(0u);
+		std::atomic<int> expansions(0), queueLengths(0), superseded(0), duplicates(0), localLoopsAvoided(0);
+		inboxes[owner(initialNode)].send(initialNode);
+
+		runOnThreads(threadCount, [&]()
+		{
+			const unsigned int self = nextThread.fetch_add(1u, std::memory_order_relaxed);
+			Allocator allocator(pool);
+			Inbox& inbox = inboxes[self];
+			PriorityQueue<Node*, Vector<Node*>, GreaterHeuistic<Map_t>> open;
+			HashMap<Node*, ListNodeHasher<Map_t, 10>, ListNodeEqualityTester<Map_t>> best;
+			int expanded = 0, maxOpen = 0, replaced = 0, discarded = 0, loopsAvoided = 0;
+			try
+			{
+				while (!outOfMemory.load(std::memory_order_relaxed) && !stopped.load(std::memory_order_relaxed))
+				{
+					for (Node* message = inbox.receiveAll(); message != nullptr;)
+					{
+						Node* node = message;
+						message = node->data.nextMessage;
+						//The number of moves to a state is f - g
+						auto existing = best.find(node);
+						if (existing != best.end() && (*existing)->data.f - (*existing)->data.g <= node->data.f - node->data.g)
+						{
+							node->~Node();
+							Allocator::release(node);
+							++discarded;
+						}
+						else
+						{
+							if (existing != best.end())
+							{
+								(*existing)->data.superseded = true;
+								*existing = node;
+								++replaced;
+							}
+							else
+							{
+								best.insert(node);
+							}
+							open.push(node);
+							if (open.size() > (size_t)maxOpen) maxOpen = (int)open.size();
+						}
+						activeWork.fetch_sub(1);
+					}
+
+					if (open.empty() || open.top()->data.f >= incumbentF.load(std::memory_order_acquire))
+					{
+						//Nothing here can lead to a better solution until another thread sends something
+						activeWork.fetch_sub(1);
+						while (inbox.empty() && activeWork.load() != 0 && !outOfMemory.load(std::memory_order_relaxed) && !stopped.load(std::memory_order_relaxed))
+						{
+							std::this_thread::yield();
+						}
+						if (inbox.empty()) break;
+						activeWork.fetch_add(1);
+						continue;
+					}
+
+					Node* currentPath = open.top();
+					open.pop();
+					Map_t& currentState = currentPath->data;
+					if (currentState.superseded)
+					{
+						//Superseded states are never expanded so nothing points to them
+						currentPath->~Node();
+						Allocator::release(currentPath);
+						continue;
+					}
+					if (currentState == goal)
+					{
+						std::lock_guard<std::mutex> lock(incumbentMutex);
+						if (currentState.f < incumbentF.load(std::memory_order_relaxed))
+						{
+							incumbent = currentPath;
+							incumbentF.store(currentState.f, std::memory_order_release);
+						}
+						continue;
+					}
+
+					const size_t emptyPos = currentState.emptyPos;
+					const size_t newPositions[4] = { emptyPos - width, emptyPos + 1u, emptyPos + width, emptyPos - 1u };
+					const bool canMove[4] = { emptyPos / width != 0u, emptyPos % width != width - 1u, emptyPos / width != height - 1u, emptyPos % width != 0u };
+					//Moving the empty tile back to where it just came from would only recreate the parent state
+					const size_t parentPos = currentPath->next != nullptr ? currentPath->next->data.emptyPos : width * height;
+					for (size_t direction = 0u; direction != 4u; ++direction)
+					{
+						if (!canMove[direction] || newPositions[direction] == parentPos) continue;
+						Node* child = (Node*)allocator.getNext();
+						new(child) Node{ currentState, currentPath };
+						child->data.emptyPos = newPositions[direction];
+						child->data.tiles[emptyPos] = child->data.tiles[newPositions[direction]];
+						child->data.tiles[newPositions[direction]] = 0;
+						calculateHeuristic<heuristic>(child, currentState, goal, (unsigned int)emptyPos, (unsigned int)newPositions[direction]);
+						if (child->data.f >= incumbentF.load(std::memory_order_relaxed))
+						{
+							child->~Node();
+							allocator.replaceLast();
+							continue;
+						}
+						child->data.superseded = false;
+						activeWork.fetch_add(1);
+						inboxes[owner(child)].send(child);
+					}
+					if (currentPath->next != nullptr) ++loopsAvoided;
+					++expanded;
+					if (shouldStop(cancellation, expanded)) stopped.store(true, std::memory_order_relaxed);
+				}
+			}
+			catch (std::bad_alloc)
+			{
+				outOfMemory.store(true, std::memory_order_relaxed);
+			}
+			expansions.fetch_add(expanded, std::memory_order_relaxed);
+			queueLengths.fetch_add(maxOpen, std::memory_order_relaxed);
+			superseded.fetch_add(replaced, std::memory_order_relaxed);
+			duplicates.fetch_add(discarded, std::memory_order_relaxed);
+			localLoopsAvoided.fetch_add(loopsAvoided, std::memory_order_relaxed);
+		});
+		if (outOfMemory.load(std::memory_order_relaxed)) throw std::bad_alloc();
+
+		numOfStateExpansions = expansions.load(std::memory_order_relaxed);
+		//The open lists are separate so their largest sizes are added up
+		maxQLength = queueLengths.load(std::memory_order_relaxed);
+		numOfDeletionsFromMiddleOfHeap = superseded.load(std::memory_order_relaxed);
+		numOfAttemptedNodeReExpansions = duplicates.load(std::memory_order_relaxed);
+		numOfLocalLoopsAvoided = localLoopsAvoided.load(std::memory_order_relaxed);
+
+		//A goal found before the search was stopped might not be on a shortest path
+		if (stopped.load(std::memory_order_relaxed))
+		{
+			path = stoppedPath(cancellation);
+		}
+		else if (incumbent != nullptr)
+		{
+			path = packPath(incumbent);
+		}
+		else
+		{
+			path = "";
+		}
+
+	}
+	catch (std::bad_alloc)
+	{
+		path = "OOM";
+	}
+
+	actualRunningTime = std::chrono::duration<float>(std::chrono::steady_clock::now() - startTime).count();
+
+	return path;
+}
+
+string hashDistributedAStar(string const& initialState, string const& goalState, int &numOfStateExpansions, int& maxQLength, float &actualRunningTime,
+	int &numOfDeletionsFromMiddleOfHeap, int &numOfLocalLoopsAvoided, int &numOfAttemptedNodeReExpansions, heuristicFunction heuristic, unsigned int threadCount,
+	const CancellationToken* cancellation){
+
+	if (heuristic == heuristicFunction::manhattanDistance)
+	{
+		return hashDistributedAStar<manhattanDistance>(initialState, goalState, numOfStateExpansions, maxQLength, actualRunningTime,
+			numOfDeletionsFromMiddleOfHeap, numOfLocalLoopsAvoided, numOfAttemptedNodeReExpansions, threadCount, cancellation);
+	}
+	else if (heuristic == heuristicFunction::linearConflict)
+	{
+		return hashDistributedAStar<linearConflict>(initialState, goalState, numOfStateExpansions, maxQLength, actualRunningTime,
+			numOfDeletionsFromMiddleOfHeap, numOfLocalLoopsAvoided, numOfAttemptedNodeReExpansions, threadCount, cancellation);
+	}
+	else if (heuristic == heuristicFunction::walkingDistance)
+	{
+		return hashDistributedAStar<walkingDistance>(initialState, goalState, numOfStateExpansions, maxQLength, actualRunningTime,
+			numOfDeletionsFromMiddleOfHeap, numOfLocalLoopsAvoided, numOfAttemptedNodeReExpansions, threadCount, cancellation);
+	}
+	else if (heuristic == heuristicFunction::patternDatabase)
+	{
+		return hashDistributedAStar<patternDatabase>(initialState, goalState, numOfStateExpansions, maxQLength, actualRunningTime,
+			numOfDeletionsFromMiddleOfHeap, numOfLocalLoopsAvoided, numOfAttemptedNodeReExpansions, threadCount, cancellation);
+	}
+	else
+	{
+		return hashDistributedAStar<misplacedTiles>(initialState, goalState, numOfStateExpansions, maxQLength, actualRunningTime,
+			numOfDeletionsFromMiddleOfHeap, numOfLocalLoopsAvoided, numOfAttemptedNodeReExpansions, threadCount, cancellation);
+	}
+}
+
+/*
+* Parallel A* with every thread sharing one relaxed open list, a MultiQueue, and one table of the best paths found, a ConcurrentHashMap.
+* The open list only hands out states close to the best one, so a state can be expanded before the best path to it has been found. It is
+* expanded again once that path reaches it, and a goal is only a bound on the cost of the solution: the search carries on until nothing
+* left has a smaller f value. outstanding counts the states pushed but not yet expanded, so once it reaches 0 no thread can make more work.
+*/
+template<heuristicFunction heuristic>
+string multiQueueAStar(string const& initialState, string const& goalState, int &numOfStateExpansions, int& maxQLength, float &actualRunningTime,
+	int &numOfDeletionsFromMiddleOfHeap, int &numOfLocalLoopsAvoided, int &numOfAttemptedNodeReExpansions, unsigned int threadCount,
+	const CancellationToken* cancellation)
+{
+	string path;
+
+	constexpr size_t width = 3, height = 3;
+	constexpr unsigned int infinity = std::numeric_limits<unsigned int>::max();
+	using Map_t = MapWithHuristic<width, height, char, heuristic>;
+	using Node = ListNode<Map_t>;
+	using Allocator = ThreadSlabAllocator<sizeof(Node), alignof(Node)>;
+	Map<width, height> goal;
+
+	numOfDeletionsFromMiddleOfHeap = 0;
+	numOfLocalLoopsAvoided = 0;
+	numOfAttemptedNodeReExpansions = 0;
+	numOfStateExpansions = 0;
+	maxQLength = 1;
+	if (threadCount == 0u) threadCount = std::thread::hardware_concurrency();
+	if (threadCount == 0u) threadCount = 1u;
+
+	//Wall clock time because clock() adds up the time of every thread
+	const auto startTime = std::chrono::steady_clock::now();
+
+	try
+	{
+
+		for (size_t i = 0; i != goalState.size(); ++i)
+		{
+			if (goalState[i] == '0')
+			{
+				goal.tiles[i] = 0;
+				goal.emptyPos = i;
+			}
+			else
+			{
+				goal.tiles[i] = goalState[i] - '0';
+			}
+		}
+
+		//Nodes that are expanded stay allocated until the pool is destructed because other threads hold pointers to them as parents
+		typename Allocator::Pool pool;
+		Allocator initialAllocator(pool);
+		MultiQueue<Node*, GreaterHeuistic<Map_t>> open(threadCount);
+		ConcurrentHashMap<Node*, ListNodeHasher<Map_t, 10>, ListNodeEqualityTester<Map_t>> best(threadCount * 64u);
+
+		Node* initialNode = (Node*)initialAllocator.getNext();
+		new(initialNode) Node{ Map_t(), nullptr };
+		for (size_t i = 0; i != initialState.size(); ++i)
+		{
+			if (initialState[i] == '0')
+			{
+				initialNode->data.tiles[i] = 0;
+				initialNode->data.emptyPos = i;
+			}
+			else
+			{
+				initialNode->data.tiles[i] = initialState[i] - '0';
+			}
+		}
+		initializeHeuristic<heuristic>(initialNode->data, goal);
+
+		std::atomic<unsigned int> incumbentF(infinity);
+		Node* incumbent = nullptr;
+		std::mutex incumbentMutex;
+		std::atomic<long> outstanding(1);
+		std::atomic<bool> outOfMemory(false);
+		//Set by the first thread to find the token stopped so the rest stop too
+		std::atomic<bool> stopped(false);
+		std::atomic<int> expansions(0), queueLength(1), superseded(0), duplicates(0), localLoopsAvoided(0);
+		best.insert(initialNode);
+		open.push(initialNode);
+
+		runOnThreads(threadCount, [&]()
+		{
+			Allocator allocator(pool);
+			int expanded = 0, maxOpen = 0, replaced = 0, discarded = 0, loopsAvoided = 0;
+			try
+			{
+				while (!outOfMemory.load(std::memory_order_relaxed) && !stopped.load(std::memory_order_relaxed))
+				{
+					Node* currentPath;
+					if (!open.tryPop(currentPath))
+					{
+						//The queue can look empty while another thread is still adding the children of the state it is expanding
+						if (outstanding.load() == 0) break;
+						std::this_thread::yield();
+						continue;
+					}
+
+					Map_t& currentState = currentPath->data;
+					Node* bestPath = nullptr;
+					best.find(currentPath, bestPath);
+					if (bestPath != currentPath)
+					{
+						//A shorter path to this state has been found. Nothing points to this one as it was never expanded.
+						currentPath->~Node();
+						Allocator::release(currentPath);
+						outstanding.fetch_sub(1);
+						continue;
+					}
+					if (currentState.f >= incumbentF.load(std::memory_order_acquire))
+					{
+						//Can't lead to a better solution
+						outstanding.fetch_sub(1);
+						continue;
+					}
+					if (currentState == goal)
+					{
+						std::lock_guard<std::mutex> lock(incumbentMutex);
+						if (currentState.f < incumbentF.load(std::memory_order_relaxed))
+						{
+							incumbent = currentPath;
+							incumbentF.store(currentState.f, std::memory_order_release);
+						}
+						outstanding.fetch_sub(1);
+						continue;
+					}
+
+					const size_t emptyPos = currentState.emptyPos;
+					const size_t newPositions[4] = { emptyPos - width, emptyPos + 1u, emptyPos + width, emptyPos - 1u };
+					const bool canMove[4] = { emptyPos / width != 0u, emptyPos % width != width - 1u, emptyPos / width != height - 1u, emptyPos % width != 0u };
+					//Moving the empty tile back to where it just came from would only recreate the parent state
+					const size_t parentPos = currentPath->next != nullptr ? currentPath->next->data.emptyPos : width * height;
+					for (size_t direction = 0u; direction != 4u; ++direction)
+					{
+						if (!canMove[direction] || newPositions[direction] == parentPos) continue;
+						Node* child = (Node*)allocator.getNext();
+						new(child) Node{ currentState, currentPath };
+						child->data.emptyPos = newPositions[direction];
+						child->data.tiles[emptyPos] = child->data.tiles[newPositions[direction]];
+						child->data.tiles[newPositions[direction]] = 0;
+						calculateHeuristic<heuristic>(child, currentState, goal, (unsigned int)emptyPos, (unsigned int)newPositions[direction]);
+						if (child->data.f >= incumbentF.load(std::memory_order_relaxed))
+						{
+							child->~Node();
+							allocator.replaceLast();
+							continue;
+						}
+						//The number of moves to a state is f - g
+						bool duplicate = false;
+						best.insertOrUpdate(child, [&](Node*& existing)
+						{
+							if (existing->data.f - existing->data.g <= child->data.f - child->data.g)
+							{
+								duplicate = true;
+							}
+							else
+							{
+								existing = child;
+								++replaced;
+							}
+						});
+						if (duplicate)
+						{
+							child->~Node();
+							allocator.replaceLast();
+							++discarded;
+							continue;
+						}
+						outstanding.fetch_add(1);
+						open.push(child);
+					}
+					if ((int)open.size() > maxOpen) maxOpen = (int)open.size();
+					if (currentPath->next != nullptr) ++loopsAvoided;
+					++expanded;
+					if (shouldStop(cancellation, expanded)) stopped.store(true, std::memory_order_relaxed);
+					outstanding.fetch_sub(1);
+				}
+			}
+			catch (std::bad_alloc)
+			{
+				outOfMemory.store(true, std::memory_order_relaxed);
+			}
+			expansions.fetch_add(expanded, std::memory_order_relaxed);
+			//The open list is shared so the largest size any thread saw is its largest size
+			int longest = queueLength.load(std::memory_order_relaxed);
+			while (maxOpen > longest && !queueLength.compare_exchange_weak(longest, maxOpen, std::memory_order_relaxed))
+			{
+			}
+			superseded.fetch_add(replaced, std::memory_order_relaxed);
+			duplicates.fetch_add(discarded, std::memory_order_relaxed);
+			localLoopsAvoided.fetch_add(loopsAvoided, std::memory_order_relaxed);
+		});
+		if (outOfMemory.load(std::memory_order_relaxed)) throw std::bad_alloc();
+
+		numOfStateExpansions = expansions.load(std::memory_order_relaxed);
+		maxQLength = queueLength.load(std::memory_order_relaxed);
+		numOfDeletionsFromMiddleOfHeap = superseded.load(std::memory_order_relaxed);
+		numOfAttemptedNodeReExpansions = duplicates.load(std::memory_order_relaxed);
+		numOfLocalLoopsAvoided = localLoopsAvoided.load(std::memory_order_relaxed);
+
+		//A goal found before the search was stopped might not be on a shortest path
+		if (stopped.load(std::memory_order_relaxed))
+		{
+			path = stoppedPath(cancellation);
+		}
+		else if (incumbent != nullptr)
+		{
+			path = packPath(incumbent);
+		}
+		else
+		{
+			path = "";
+		}
+
+	}
+	catch (std::bad_alloc)
+	{
+		path = "OOM";
+	}
+
+	actualRunningTime = std::chrono::duration<float>(std::chrono::steady_clock::now() - startTime).count();
+
+	return path;
+}
+
+string multiQueueAStar(string const& initialState, string const& goalState, int &numOfStateExpansions, int& maxQLength, float &actualRunningTime,
+	int &numOfDeletionsFromMiddleOfHeap, int &numOfLocalLoopsAvoided, int &numOfAttemptedNodeReExpansions, heuristicFunction heuristic, unsigned int threadCount,
+	const CancellationToken* cancellation){
+
+	if (heuristic == heuristicFunction::manhattanDistance)
+	{
+		return multiQueueAStar<manhattanDistance>(initialState, goalState, numOfStateExpansions, maxQLength, actualRunningTime,
+			numOfDeletionsFromMiddleOfHeap, numOfLocalLoopsAvoided, numOfAttemptedNodeReExpansions, threadCount, cancellation);
+	}
+	else if (heuristic == heuristicFunction::linearConflict)
+	{
+		return multiQueueAStar<linearConflict>(initialState, goalState, numOfStateExpansions, maxQLength, actualRunningTime,
+			numOfDeletionsFromMiddleOfHeap, numOfLocalLoopsAvoided, numOfAttemptedNodeReExpansions, threadCount, cancellation);
+	}
+	else if (heuristic == heuristicFunction::walkingDistance)
+	{
+		return multiQueueAStar<walkingDistance>(initialState, goalState, numOfStateExpansions, maxQLength, actualRunningTime,
+			numOfDeletionsFromMiddleOfHeap, numOfLocalLoopsAvoided, numOfAttemptedNodeReExpansions, threadCount, cancellation);
+	}
+	else if (heuristic == heuristicFunction::patternDatabase)
+	{
+		return multiQueueAStar<patternDatabase>(initialState, goalState, numOfStateExpansions, maxQLength, actualRunningTime,
+			numOfDeletionsFromMiddleOfHeap, numOfLocalLoopsAvoided, numOfAttemptedNodeReExpansions, threadCount, cancellation);
+	}
+	else
+	{
+		return multiQueueAStar<misplacedTiles>(initialState, goalState, numOfStateExpansions, maxQLength, actualRunningTime,
+			numOfDeletionsFromMiddleOfHeap, numOfLocalLoopsAvoided, numOfAttemptedNodeReExpansions, threadCount, cancellation);
+	}
+}
+
+/*
+* Returns true if the goal state can be reached from the initial state.
+* Every move swaps the empty tile with another tile which changes both the parity of the permutation between the two states and the parity of the
+* distance between the two empty tile positions so the two parities must match.
+*/
+template<class Map, class Goal>
+static bool isSolvable(const Map& initial, const Goal& goal)
+{
+	constexpr size_t tileCount = Map::width * Map::height;
+	size_t goalPositions[tileCount];
+	for (size_t i = 0u; i != tileCount; ++i)
+	{
+		for (size_t j = 0u; j != tileCount; ++j)
+		{
+			if (initial.tiles[i] == goal.tiles[j])
+			{
+				goalPositions[i] = j;
+				break;
+			}
+		}
+	}
+	size_t inversions = 0u;
+	for (size_t i = 0u; i != tileCount; ++i)
+	{
+		for (size_t j = i + 1u; j != tileCount; ++j)
+		{
+			if (goalPositions[i] > goalPositions[j]) ++inversions;
+		}
+	}
+	size_t x1 = initial.emptyPos % Map::width;
+	size_t y1 = initial.emptyPos / Map::width;
+	size_t x2 = goal.emptyPos % Map::width;
+	size_t y2 = goal.emptyPos / Map::width;
+	size_t emptyTileDistance = (x1 > x2 ? x1 - x2 : x2 - x1) + (y1 > y2 ? y1 - y2 : y2 - y1);
+	return (inversions & 1u) == (emptyTileDistance & 1u);
+}
+
+/*
+* Moves the empty tile of state one step in the direction of move, which is one of the moves of a path.
+*/
+template<class Map>
+void moveEmptyTile(Map& state, char move)
+{
+	const size_t emptyPos = state.emptyPos;
+	const size_t newPos = move == 'U' ? emptyPos - Map::width : move == 'R' ? emptyPos + 1u : move == 'D' ? emptyPos + Map::width : emptyPos - 1u;
+	state.tiles[emptyPos] = state.tiles[newPos];
+	state.tiles[newPos] = 0;
+	state.emptyPos = newPos;
+}
+
+inline char oppositeMove(char move)
+{
+	return move == 'U' ? 'D' : move == 'R' ? 'L' : move == 'D' ? 'U' : 'R';
+}
+
+/*
+* A state reached by one direction of bidirectional breadth-first search with the move that reached it and its distance from where that
+* direction started.
+*/
+struct BidirectionalEntry
+{
+	uint64_t key;
+	char move;
+	unsigned char depth;
+};
+
+/*
+* One direction of bidirectional breadth-first search. order holds the states in the order they were reached so the level being expanded
+* is every state from levelStart on.
+*/
+struct BidirectionalSide
+{
+	HashMap<BidirectionalEntry, PackedStateHasher<BidirectionalEntry>, PackedStateEqualityTester<BidirectionalEntry>> reached;
+	Vector<uint64_t> order;
+	size_t levelStart = 0u;
+	unsigned int depth = 0u;
+
+	size_t levelSize() const
+	{
+		return order.size() - levelStart;
+	}
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////
+//
+// Search Algorithm:  Bidirectional Breadth-First Search
+//
+// Move Generator:  
+//
+////////////////////////////////////////////////////////////////////////////////////////////
+/*
+* Searches forwards from the initial state and backwards from the goal, expanding a whole level of whichever direction has the smaller
+* level. A solution needs about half as many moves from each end, so far fewer states are reached than by a breadth-first search from one end.
+* The first state reached by both directions isn't always on a shortest path, so the rest of the level is still expanded and the shortest
+* path through any of the states both directions reached is the solution.
+*/
+string bidirectionalBreadthFirstSearch(string const& initialState, string const& goalState, int &numOfStateExpansions, int& maxQLength, float &actualRunningTime,
+	const CancellationToken* cancellation)
+{
+	string path;
+	clock_t startTime;
+
+	constexpr size_t width = 3, height = 3;
+	using Map_t = Map<width, height>;
+	constexpr unsigned int infinity = std::numeric_limits<unsigned int>::max();
+	const char moves[4] = { 'U', 'R', 'D', 'L' };
+	Map_t initial, goal;
+
+	numOfStateExpansions = 0;
+	maxQLength = 1;
+
+	startTime = clock();
+
+	try
+	{
+		for (size_t i = 0; i != goalState.size(); ++i)
+		{
+			if (goalState[i] == '0')
+			{
+				goal.tiles[i] = 0;
+				goal.emptyPos = i;
+			}
+			else
+			{
+				goal.tiles[i] = goalState[i] - '0';
+			}
+		}
+
+		for (size_t i = 0; i != initialState.size(); ++i)
+		{
+			if (initialState[i] == '0')
+			{
+				initial.tiles[i] = 0;
+				initial.emptyPos = i;
+			}
+			else
+			{
+				initial.tiles[i] = initialState[i] - '0';
+			}
+		}
+
+		BidirectionalSide forward, backward;
+		forward.reached.insert(BidirectionalEntry{ packState(initial), 0, 0u });
+		forward.order.push_back(packState(initial));
+		backward.reached.insert(BidirectionalEntry{ packState(goal), 0, 0u });
+		backward.order.push_back(packState(goal));
+
+		unsigned int solutionLength = infinity;
+		uint64_t meetingKey = 0u;
+		bool cancelled = false;
+		//Both directions would reach every state they can without meeting if the goal can't be reached
+		if (initial != goal && isSolvable(initial, goal))
+		{
+			while (solutionLength == infinity && !cancelled && forward.levelSize() != 0u && backward.levelSize() != 0u)
+			{
+				BidirectionalSide& side = forward.levelSize() <= backward.levelSize() ? forward : backward;
+				const BidirectionalSide& other = &side == &forward ? backward : forward;
+				const size_t levelEnd = side.order.size();
+				for (size_t i = side.levelStart; i != levelEnd; ++i)
+				{
+					if (shouldStop(cancellation, numOfStateExpansions))
+					{
+						cancelled = true;
+						break;
+					}
+					Map_t state;
+					unpackState(side.order[i], state);
+					const size_t emptyPos = state.emptyPos;
+					const bool canMove[4] = { emptyPos / width != 0u, emptyPos % width != width - 1u, emptyPos / width != height - 1u, emptyPos % width != 0u };
+					for (size_t direction = 0u; direction != 4u; ++direction)
+					{
+						if (!canMove[direction]) continue;
+						moveEmptyTile(state, moves[direction]);
+						const BidirectionalEntry child{ packState(state), moves[direction], (unsigned char)(side.depth + 1u) };
+						moveEmptyTile(state, oppositeMove(moves[direction]));
+						if (side.reached.find(child) != side.reached.end()) continue;
+						side.reached.insert(child);
+						side.order.push_back(child.key);
+						auto met = other.reached.find(child);
+						if (met != other.reached.end() && side.depth + 1u + (*met).depth < solutionLength)
+						{
+							solutionLength = side.depth + 1u + (*met).depth;
+							meetingKey = child.key;
+						}
+					}
+					++numOfStateExpansions;
+				}
+				side.levelStart = levelEnd;
+				++side.depth;
+				if (forward.levelSize() + backward.levelSize() > (size_t)maxQLength)
+				{
+					maxQLength = (int)(forward.levelSize() + backward.levelSize());
+				}
+			}
+		}
+
+		if (solutionLength != infinity)
+		{
+			//Follows the moves back from the meeting state to the initial state, then on from the meeting state to the goal
+			Map_t state;
+			unpackState(meetingKey, state);
+			for (auto entry = forward.reached.find(BidirectionalEntry{ meetingKey, 0, 0u }); (*entry).depth != 0u;
+				entry = forward.reached.find(BidirectionalEntry{ packState(state), 0, 0u }))
+			{
+				path.push_back((*entry).move);
+				moveEmptyTile(state, oppositeMove((*entry).move));
+			}
+			std::reverse(path.begin(), path.end());
+			unpackState(meetingKey, state);
+			for (auto entry = backward.reached.find(BidirectionalEntry{ meetingKey, 0, 0u }); (*entry).depth != 0u;
+				entry = backward.reached.find(BidirectionalEntry{ packState(state), 0, 0u }))
+			{
+				path.push_back(oppositeMove((*entry).move));
+				moveEmptyTile(state, oppositeMove((*entry).move));
+			}
+		}
+		else if (cancelled)
+		{
+			path = stoppedPath(cancellation);
+		}
+		else
+		{
+			path = "";
+		}
+	}
+	catch (std::bad_alloc)
+	{
+		path = "OOM";
+	}
+
+	actualRunningTime = ((float)(clock() - startTime) / CLOCKS_PER_SEC);
+
+	return path;
+}
+
+/*
+* No one search is fastest on every puzzle: A* needs the fewest expansions with a good heuristic but can run out of memory, iterative
+* deepening A* needs almost no memory but expands states again every iteration, and bidirectional breadth-first search does best on short
+* solutions whatever the heuristic. Racing them on their own threads answers about as quickly as the best of them would have.
+* Every search returns a shortest path, so the first one to answer wins and the others are cancelled. A search that runs out of memory
+* hasn't answered anything so the others carry on. Cancelling the portfolio's own token stops all of them.
+*/
+string portfolioSearch(string const& initialState, string const& goalState, int &numOfStateExpansions, int& maxQLength, float &actualRunningTime,
+	int &numOfDeletionsFromMiddleOfHeap, int &numOfLocalLoopsAvoided, int &numOfAttemptedNodeReExpansions, heuristicFunction heuristic,
+	const CancellationToken* cancellation)
+{
+	constexpr unsigned int searchCount = 3u;
+	struct SearchResult
+	{
+		string path;
+		int numOfStateExpansions = 0;
+		int maxQLength = 0;
+		float actualRunningTime = 0.0f;
+		int numOfDeletionsFromMiddleOfHeap = 0;
+		int numOfLocalLoopsAvoided = 0;
+		int numOfAttemptedNodeReExpansions = 0;
+	};
+	SearchResult results[searchCount];
+	CancellationToken racing(cancellation);
+	std::mutex winnerMutex;
+	unsigned int winner = searchCount;
+	std::atomic<unsigned int> nextSearch(0u);
+	const auto startTime = std::chrono::steady_clock::now();
+
+	runOnThreads(searchCount, [&]()
+	{
+		const unsigned int search = nextSearch.fetch_add(1u, std::memory_order_relaxed);
+		SearchResult& result = results[search];
+		if (search == 0u)
+		{
+			result.path = aStar_ExpandedList(initialState, goalState, result.numOfStateExpansions, result.maxQLength, result.actualRunningTime,
+				result.numOfDeletionsFromMiddleOfHeap, result.numOfLocalLoopsAvoided, result.numOfAttemptedNodeReExpansions, heuristic, 0u, &racing);
+		}
+		else if (search == 1u)
+		{
+			result.path = iterativeDeepeningAStar(initialState, goalState, result.numOfStateExpansions, result.maxQLength, result.actualRunningTime,
+				heuristic, 0u, 0u, &racing);
+		}
+		else
+		{
+			result.path = bidirectionalBreadthFirstSearch(initialState, goalState, result.numOfStateExpansions, result.maxQLength, result.actualRunningTime,
+				&racing);
+		}
+		if (result.path == "OOM" || result.path == "CANCELLED" || result.path == "TIMEOUT") return;
+
+		std::lock_guard<std::mutex> lock(winnerMutex);
+		if (winner == searchCount)
+		{
+			winner = search;
+			actualRunningTime = std::chrono::duration<float>(std::chrono::steady_clock::now() - startTime).count();
+			racing.cancel();
+		}
+	});
+
+	numOfStateExpansions = 0;
+	maxQLength = 0;
+	numOfDeletionsFromMiddleOfHeap = 0;
+	numOfLocalLoopsAvoided = 0;
+	numOfAttemptedNodeReExpansions = 0;
+	for (unsigned int i = 0u; i != searchCount; ++i)
+	{
+		numOfStateExpansions += results[i].numOfStateExpansions;
+		if (results[i].maxQLength > maxQLength) maxQLength = results[i].maxQLength;
+		numOfDeletionsFromMiddleOfHeap += results[i].numOfDeletionsFromMiddleOfHeap;
+		numOfLocalLoopsAvoided += results[i].numOfLocalLoopsAvoided;
+		numOfAttemptedNodeReExpansions += results[i].numOfAttemptedNodeReExpansions;
+	}
+	if (winner == searchCount)
+	{
+		actualRunningTime = std::chrono::duration<float>(std::chrono::steady_clock::now() - startTime).count();
+		return cancellation != nullptr && cancellation->isCancelled() ? stoppedPath(cancellation) : "OOM";
+	}
+	return results[winner].path;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+//
+// Search Algorithm:  Automatic selection
+//
+// Move Generator:  
+//
+////////////////////////////////////////////////////////////////////////////////////////////
+/*
+* Adds the moves from state to the goal onto the end of path. The table is a pattern database holding every tile so its distances are
+* exact and a neighbour one move closer to the goal is always there.
+*/
+template<class Database, class Map>
+static void appendCompleteTablePath(const Database& table, Map state, string& path)
+{
+	constexpr size_t width = Map::width, height = Map::height;
+	const char moves[4] = { 'U', 'R', 'D', 'L' };
+	for (unsigned int remaining = table.distance(state); remaining != 0u; --remaining)
+	{
+		const size_t emptyPos = state.emptyPos;
+		const size_t newPositions[4] = { emptyPos - width, emptyPos + 1u, emptyPos + width, emptyPos - 1u };
+		const bool canMove[4] = { emptyPos / width != 0u, emptyPos % width != width - 1u, emptyPos / width != height - 1u, emptyPos % width != 0u };
+		for (size_t direction = 0u; direction != 4u; ++direction)
+		{
+			if (!canMove[direction]) continue;
+			state.tiles[emptyPos] = state.tiles[newPositions[direction]];
+			state.tiles[newPositions[direction]] = 0;
+			state.emptyPos = newPositions[direction];
+			if (table.distance(state, remaining) == remaining - 1u)
+			{
+				path.push_back(moves[direction]);
+				break;
+			}
+			state.tiles[newPositions[direction]] = state.tiles[emptyPos];
+			state.tiles[emptyPos] = 0;
+			state.emptyPos = emptyPos;
+		}
+	}
+}
+
+/*
+* Picks the engine expected to solve a puzzle soonest from a cheap estimate of how hard it is, then runs it.
+* Puzzles whose goal can't be reached are answered from the parity of the tiles without searching. Otherwise the number of states
+* iterative deepening A* and A* would expand using the Manhattan distance is predicted with the formula of Korf, Reid and Edelkamp: a
+* search with threshold t expands about the sum over depths i of N(i) P(t - i), where N(i) is the number of move sequences of length i
+* that don't undo the previous move and P(v) is the fraction of states with a heuristic value of at most v, found from a sample of random
+* states. The solution length is taken to be the first length with the right parity that is at least the initial heuristic value and
+* at which there are as many move sequences as states they could reach.
+* A* is only picked if the states it is expected to store fit in memory, and each A* expansion counts as several of iterative deepening
+* A*'s. Building a table of the distance of every state to the goal costs one breadth-first search over every state, so it is picked when
+* that is cheaper than either search, and used without searching at all for any later puzzle with the same goal. The table is a pattern
+* database holding every tile, so like the other pattern databases it is mapped from PUZZLE_TABLE_DIR if that is set and saved there
+* after it is built.
+*/
+string autoSearch(string const& initialState, string const& goalState, int &numOfStateExpansions, int& maxQLength, float &actualRunningTime,
+	int &numOfDeletionsFromMiddleOfHeap, int &numOfLocalLoopsAvoided, int &numOfAttemptedNodeReExpansions, const CancellationToken* cancellation)
+{
+	constexpr size_t width = 3, height = 3;
+	constexpr size_t tileCount = width * height;
+	using Map_t = Map<width, height>;
+	using AStarNode = ListNode<MapWithHuristic<width, height, char, manhattanDistance>>;
+	using CompleteTable = PatternDatabase<width, height, Mod3Packing>;
+	constexpr unsigned int sampleCount = 1000u;
+	constexpr size_t maxHeuristicValue = (tileCount - 1u) * (width - 1u + height - 1u);
+	//How many iterative deepening A* expansions an A* expansion and adding a state to the table take as long as
+	constexpr double aStarExpansionCost = 4.0;
+	constexpr double tableStateCost = 2.0;
+	//A* stores a node for every state it reaches along with an entry in the open list and the expanded list
+	constexpr double aStarMemoryLimit = 512.0 * 1024.0 * 1024.0;
+	constexpr double aStarStateSize = sizeof(AStarNode) + 3u * sizeof(void*);
+
+	numOfStateExpansions = 0;
+	maxQLength = 0;
+	actualRunningTime = 0.0f;
+	numOfDeletionsFromMiddleOfHeap = 0;
+	numOfLocalLoopsAvoided = 0;
+	numOfAttemptedNodeReExpansions = 0;
+
+	const clock_t startTime = clock();
+	Map_t initial, goal;
+	for (size_t i = 0; i != goalState.size(); ++i)
+	{
+		goal.tiles[i] = goalState[i] - '0';
+		if (goal.tiles[i] == 0) goal.emptyPos = i;
+	}
+	for (size_t i = 0; i != initialState.size(); ++i)
+	{
+		initial.tiles[i] = initialState[i] - '0';
+		if (initial.tiles[i] == 0) initial.emptyPos = i;
+	}
+
+	if (!isSolvable(initial, goal))
+	{
+		actualRunningTime = ((float)(clock() - startTime) / CLOCKS_PER_SEC);
+		return "";
+	}
+
+	static TableCache<Map_t, CompleteTable, tableCacheCapacity> completeTables;
+	std::shared_ptr<const CompleteTable> table = completeTables.find(goal);
+	bool useTable = table != nullptr;
+	bool useAStar = false;
+	if (!useTable)
+	{
+		//Half the permutations of the tiles can reach the goal
+		double stateCount = 1.0;
+		for (size_t i = 2u; i <= tileCount; ++i) stateCount *= (double)i;
+		stateCount /= 2.0;
+
+		//The heuristic values of random states that can reach the goal, made by shuffling the tiles and swapping two if they can't.
+		//They only depend on the goal so each thread keeps the last ones it found.
+		thread_local Map_t sampledGoal;
+		thread_local bool sampled = false;
+		thread_local double atMost[maxHeuristicValue + 1u];
+		if (!sampled || sampledGoal != goal)
+		{
+			std::fill(atMost, atMost + maxHeuristicValue + 1u, 0.0);
+			std::mt19937 random(12345u);
+			Map_t sample = goal;
+			for (unsigned int i = 0u; i != sampleCount; ++i)
+			{
+				std::shuffle(sample.tiles, sample.tiles + tileCount, random);
+				for (size_t pos = 0u; pos != tileCount; ++pos)
+				{
+					if (sample.tiles[pos] == 0) sample.emptyPos = pos;
+				}
+				if (!isSolvable(sample, goal))
+				{
+					const size_t first = sample.emptyPos != 0u ? 0u : 1u;
+					const size_t second = sample.emptyPos != 2u ? 2u : 1u;
+					std::swap(sample.tiles[first], sample.tiles[second]);
+				}
+				atMost[heuristicValue<manhattanDistance>(sample, goal)] += 1.0 / sampleCount;
+			}
+			for (size_t v = 1u; v <= maxHeuristicValue; ++v) atMost[v] += atMost[v - 1u];
+			sampledGoal = goal;
+			sampled = true;
+		}
+
+		//Move sequences of each length from the initial state that never undo the previous move, counted by where they leave the empty
+		//tile and the direction of their last move
+		const unsigned int initialHeuristic = heuristicValue<manhattanDistance>(initial, goal);
+		const unsigned int maxDepth = initialHeuristic + 2u * (unsigned int)maxHeuristicValue;
+		const int offsets[4] = { -(int)width, 1, (int)width, -1 };
+		Vector<double> sequences;
+		sequences.push_back(1.0);
+		double ending[tileCount][5] = {};
+		ending[initial.emptyPos][4] = 1.0;
+		for (unsigned int depth = 1u; depth <= maxDepth; ++depth)
+		{
+			double next[tileCount][5] = {};
+			double total = 0.0;
+			for (size_t pos = 0u; pos != tileCount; ++pos)
+			{
+				const bool canMove[4] = { pos / width != 0u, pos % width != width - 1u, pos / width != height - 1u, pos % width != 0u };
+				for (size_t last = 0u; last != 5u; ++last)
+				{
+					if (ending[pos][last] == 0.0) continue;
+					for (size_t direction = 0u; direction != 4u; ++direction)
+					{
+						if (!canMove[direction] || (last != 4u && (direction + 2u) % 4u == last)) continue;
+						next[pos + offsets[direction]][direction] += ending[pos][last];
+						total += ending[pos][last];
+					}
+				}
+			}
+			std::memcpy(ending, next, sizeof(ending));
+			sequences.push_back(total);
+		}
+
+		//Every move changes the parity of the permutation, so only half the states can be reached by sequences of the solution's parity
+		unsigned int solutionLength = initialHeuristic % 2u;
+		double reached = 0.0;
+		for (; solutionLength + 2u <= maxDepth; solutionLength += 2u)
+		{
+			reached += sequences[solutionLength];
+			if (solutionLength >= initialHeuristic && reached >= stateCount / 2.0) break;
+		}
+
+		double iterativeDeepeningExpansions = 0.0;
+		double lastIterationExpansions = 0.0;
+		for (unsigned int threshold = initialHeuristic; threshold <= solutionLength; threshold += 2u)
+		{
+			lastIterationExpansions = 0.0;
+			for (unsigned int depth = 0u; depth <= threshold; ++depth)
+			{
+				lastIterationExpansions += sequences[depth] * atMost[threshold - depth < maxHeuristicValue ? threshold - depth : maxHeuristicValue];
+			}
+			iterativeDeepeningExpansions += lastIterationExpansions;
+		}
+		//A* expands each state once at most and only those that could be on a path no longer than the solution
+		const double aStarExpansions = std::min(lastIterationExpansions,
+			stateCount * atMost[solutionLength < maxHeuristicValue ? solutionLength : maxHeuristicValue]);
+
+		const double aStarCost = aStarExpansions * aStarStateSize <= aStarMemoryLimit ? aStarExpansions * aStarExpansionCost :
+			std::numeric_limits<double>::infinity();
+		const double tableCost = stateCount * tableStateCost;
+		useTable = tableCost < iterativeDeepeningExpansions && tableCost < aStarCost;
+		useAStar = !useTable && aStarCost < iterativeDeepeningExpansions;
+	}
+
+	if (useTable)
+	{
+		string path;
+		try
+		{
+			if (table == nullptr)
+			{
+				unsigned char tiles[tileCount - 1u];
+				size_t tilesFound = 0u;
+				for (size_t pos = 0u; pos != tileCount; ++pos)
+				{
+					if (goal.tiles[pos] != 0) tiles[tilesFound++] = (unsigned char)goal.tiles[pos];
+				}
+				const char* tableDirectory = std::getenv("PUZZLE_TABLE_DIR");
+				const string tablePath = tableDirectory != nullptr && *tableDirectory != '\0' ?
+					patternDatabasePath<width, height>(tableDirectory, goal, tiles, tilesFound) : string();
+				std::unique_ptr<CompleteTable> built(new CompleteTable(goal, tiles, tilesFound, tablePath,
+					[cancellation]() { return cancellation != nullptr && cancellation->isCancelled(); }));
+				if (built->size() == 0u)
+				{
+					actualRunningTime = ((float)(clock() - startTime) / CLOCKS_PER_SEC);
+					return stoppedPath(cancellation);
+				}
+				if (!built->isMapped()) numOfStateExpansions = (int)built->size();
+				//Searches with their own deadlines each build the table rather than wait for another one's build, so if another thread
+				//finished first its table is kept and this one is freed
+				table = completeTables.get(goal, [&built]() { return built.release(); });
+			}
+			maxQLength = 1;
+			appendCompleteTablePath(*table, initial, path);
+		}
+		catch (std::bad_alloc)
+		{
+			path = "OOM";
+		}
+		actualRunningTime = ((float)(clock() - startTime) / CLOCKS_PER_SEC);
+		return path;
+	}
+
+	string path;
+	if (useAStar)
+	{
+		path = aStar_ExpandedList(initialState, goalState, numOfStateExpansions, maxQLength, actualRunningTime,
+			numOfDeletionsFromMiddleOfHeap, numOfLocalLoopsAvoided, numOfAttemptedNodeReExpansions, manhattanDistance, 0u, cancellation);
+	}
+	else
+	{
+		path = iterativeDeepeningAStar(initialState, goalState, numOfStateExpansions, maxQLength, actualRunningTime, manhattanDistance, 0u, 0u, cancellation);
+	}
+	actualRunningTime = ((float)(clock() - startTime) / CLOCKS_PER_SEC);
+	return path;
+}
+
+#ifdef HAS_WORKER_PROCESSES
+/*
+* The messages exchanged by the processes of distributed A*.
+*/
+enum DistributedMessageType : uint32_t
+{
+	childMessage,         //state is a child for the worker that owns it, value the direction of the move to it, first its depth and second its f
+	incumbentMessage,     //value is the cost of the best solution found so far
+	solutionMessage,      //a worker has reached the goal in value moves
+	statusRequestMessage,
+	statusMessage,        //value is 1 if the worker is idle, first and second the number of children it has sent and received
+	traceMessage,         //asks the owner of state for the direction of the last move of the best path to it
+	traceReplyMessage,    //value is the direction of the last move of the best path to state
+	stopMessage,
+	statisticsMessage,    //value is the expansions, state the largest open list, first the superseded and loops avoided and second the duplicates
+	outOfMemoryMessage
+};
+
+constexpr unsigned int noDirection = 4u;
+
+/*
+* The fewest moves a worker process has found to a state it owns and the direction of the last of them.
+*/
+struct DistributedEntry
+{
+	uint64_t key;
+	unsigned int depth;
+	unsigned int direction;
+};
+
+struct DistributedOpenEntry
+{
+	uint64_t key;
+	unsigned int f;
+	unsigned int depth;
+};
+
+/*
+* Orders the open list by f, deepest first among equal f values so the goal is reached sooner.
+*/
+struct GreaterDistributedF
+{
+	constexpr bool operator()(const DistributedOpenEntry& value1, const DistributedOpenEntry& value2) const
+	{
+		return value1.f > value2.f || (value1.f == value2.f && value1.depth < value2.depth);
+	}
+};
+
+/*
+* The process that owns a state. It uses different bits of the key than the tables of the workers so each table still spreads its states out.
+*/
+inline unsigned int distributedOwner(uint64_t key, unsigned int workerCount)
+{
+	return (unsigned int)((((key ^ (key >> 29u)) * 0xBF58476D1CE4E5B9u) >> 32u) % workerCount);
+}
+
+/*
+* The absolute heuristic value of a state worked out from scratch, as a worker process is only sent the tiles of a state.
+*/
+template<heuristicFunction heuristic, size_t width, size_t height>
+unsigned int heuristicValueFromScratch(const Map<width, height>& state, const Map<width, height>& goal)
+{
+	MapWithHuristic<width, height, char, heuristic> scratch;
+	static_cast<Map<width, height>&>(scratch) = state;
+	initializeHeuristic<heuristic>(scratch, goal);
+	return heuristicValue<heuristic>(scratch, goal);
+}
+
+/*
+* The loop of one worker process of distributed A*. The worker owns the states distributedOwner maps to self: it keeps their best depths,
+* expands them in order of f and sends their children to the workers that own them through peers, which is indexed by worker and null at
+* self. It expands at most a batch of states between reading its messages so children go out in batches and answers reach the coordinator
+* quickly. The worker returns when the coordinator stops it or when a process it talks to goes away.
+*/
+template<heuristicFunction heuristic, size_t width, size_t height>
+void distributedAStarWorker(unsigned int self, unsigned int workerCount, SocketChannel* const* peers, SocketChannel& coordinator,
+	const Map<width, height>& goal)
+{
+	constexpr unsigned int infinity = std::numeric_limits<unsigned int>::max();
+	constexpr unsigned int batchSize = 64u;
+	const uint64_t goalKey = packState(goal);
+	Vector<SocketChannel*> channels;
+	for (unsigned int i = 0u; i != workerCount; ++i)
+	{
+		if (i != self) channels.push_back(peers[i]);
+	}
+	channels.push_back(&coordinator);
+
+	PriorityQueue<DistributedOpenEntry, Vector<DistributedOpenEntry>, GreaterDistributedF> open;
+	HashMap<DistributedEntry, PackedStateHasher<DistributedEntry>, PackedStateEqualityTester<DistributedEntry>> best;
+	unsigned int incumbentF = infinity;
+	uint64_t sent = 0u, received = 0u;
+	unsigned int expanded = 0u, maxOpen = 0u, replaced = 0u, discarded = 0u, loopsAvoided = 0u;
+	bool running = true;
+
+	auto addChild = [&](uint64_t key, unsigned int depth, unsigned int f, unsigned int direction)
+	{
+		auto existing = best.find(DistributedEntry{ key, 0u, 0u });
+		if (existing != best.end())
+		{
+			if ((*existing).depth <= depth)
+			{
+				++discarded;
+				return;
+			}
+			//The old entry on the open list is skipped when it is popped because its depth is no longer the best
+			(*existing).depth = depth;
+			(*existing).direction = direction;
+			++replaced;
+		}
+		else
+		{
+			best.insert(DistributedEntry{ key, depth, direction });
+		}
+		open.push(DistributedOpenEntry{ key, f, depth });
+		if (open.size() > maxOpen) maxOpen = (unsigned int)open.size();
+	};
+	auto handle = [&](const ChannelMessage& message)
+	{
+		switch (message.type)
+		{
+		case childMessage:
+			++received;
+			if ((unsigned int)message.second < incumbentF) addChild(message.state, (unsigned int)message.first, (unsigned int)message.second, message.value);
+			break;
+		case incumbentMessage:
+			if (message.value < incumbentF) incumbentF = message.value;
+			break;
+		case statusRequestMessage:
+			coordinator.send(ChannelMessage{ statusMessage, open.empty() || open.top().f >= incumbentF ? 1u : 0u, 0u, sent, received });
+			break;
+		case traceMessage:
+		{
+			auto entry = best.find(DistributedEntry{ message.state, 0u, 0u });
+			coordinator.send(ChannelMessage{ traceReplyMessage, entry != best.end() ? (*entry).direction : noDirection, message.state, 0u, 0u });
+			break;
+		}
+		case stopMessage:
+			coordinator.send(ChannelMessage{ statisticsMessage, expanded, maxOpen, (uint64_t)loopsAvoided << 32u | replaced, discarded });
+			running = false;
+			break;
+		}
+	};
+
+	try
+	{
+		while (running)
+		{
+			for (SocketChannel* channel : channels)
+			{
+				if (!channel->receive()) return;
+				ChannelMessage message;
+				while (running && channel->next(message)) handle(message);
+			}
+			if (!running) break;
+
+			for (unsigned int batch = 0u; batch != batchSize && !open.empty() && open.top().f < incumbentF;)
+			{
+				const DistributedOpenEntry current = open.top();
+				open.pop();
+				auto entry = best.find(DistributedEntry{ current.key, 0u, 0u });
+				if ((*entry).depth != current.depth) continue;
+				if (current.key == goalKey)
+				{
+					incumbentF = current.f;
+					coordinator.send(ChannelMessage{ solutionMessage, current.f, current.key, 0u, 0u });
+					continue;
+				}
+
+				Map<width, height> state;
+				unpackState(current.key, state);
+				const size_t emptyPos = state.emptyPos;
+				const size_t newPositions[4] = { emptyPos - width, emptyPos + 1u, emptyPos + width, emptyPos - 1u };
+				const bool canMove[4] = { emptyPos / width != 0u, emptyPos % width != width - 1u, emptyPos / width != height - 1u, emptyPos % width != 0u };
+				//Moving the empty tile back to where it just came from would only recreate the parent state
+				const unsigned int parentDirection = (*entry).direction != noDirection ? ((*entry).direction + 2u) % 4u : noDirection;
+				for (unsigned int direction = 0u; direction != 4u; ++direction)
+				{
+					if (!canMove[direction] || direction == parentDirection) continue;
+					Map<width, height> child = state;
+					child.tiles[emptyPos] = child.tiles[newPositions[direction]];
+					child.tiles[newPositions[direction]] = 0;
+					child.emptyPos = newPositions[direction];
+					const unsigned int f = current.depth + 1u + heuristicValueFromScratch<heuristic>(child, goal);
+					if (f >= incumbentF) continue;
+					const uint64_t childKey = packState(child);
+					const unsigned int owner = distributedOwner(childKey, workerCount);
+					if (owner == self)
+					{
+						addChild(childKey, current.depth + 1u, f, direction);
+					}
+					else
+					{
+						peers[owner]->send(ChannelMessage{ childMessage, direction, childKey, current.depth + 1u, f });
+						++sent;
+					}
+				}
+				if (parentDirection != noDirection) ++loopsAvoided;
+				++expanded;
+				++batch;
+			}
+
+			for (SocketChannel* channel : channels)
+			{
+				if (!channel->flush()) return;
+			}
+			if (open.empty() || open.top().f >= incumbentF)
+			{
+				waitForChannels(channels.begin(), channels.size(), 10);
+			}
+		}
+	}
+	catch (std::bad_alloc)
+	{
+		coordinator.send(ChannelMessage{ outOfMemoryMessage, 0u, 0u, 0u, 0u });
+	}
+
+	SocketChannel* const coordinatorChannel = &coordinator;
+	while (coordinator.unsentBytes() != 0u && coordinator.flush())
+	{
+		waitForChannels(&coordinatorChannel, 1u, 10);
+	}
+}
+#endif
+
+/*
+* Hash distributed A* across processes. Each worker process owns the states hashed to it and exchanges children with the others in batches
+* over UNIX domain sockets, so the search can use the memory of several processes. This process is the coordinator: it hands the initial
+* state to its owner, passes on the cost of each better solution found so the workers can prune with it, and decides when the search is
+* over. It asks every worker in turn for whether it is idle and how many children it has sent and received, and the search is over when
+* two rounds of answers in a row are the same, add up to every child sent having been received and the second has every worker idle.
+* Counters that didn't change between the rounds mean no child was sent between them, so no idle worker can be given more work.
+* The path is then traced back from the goal by asking the owner of each state for the last move to it.
+* Worker processes are started with fork, so without them this is hash distributed A* on threads.
+*/
+template<heuristicFunction heuristic>
+string distributedAStar(string const& initialState, string const& goalState, int &numOfStateExpansions, int& maxQLength, float &actualRunningTime,
+	int &numOfDeletionsFromMiddleOfHeap, int &numOfLocalLoopsAvoided, int &numOfAttemptedNodeReExpansions, unsigned int processCount,
+	const CancellationToken* cancellation)
+{
+#ifdef HAS_WORKER_PROCESSES
+	string path;
+
+	constexpr size_t width = 3, height = 3;
+	constexpr unsigned int infinity = std::numeric_limits<unsigned int>::max();
+	Map<width, height> goal;
+	Map<width, height> initial;
+
+	numOfDeletionsFromMiddleOfHeap = 0;
+	numOfLocalLoopsAvoided = 0;
+	numOfAttemptedNodeReExpansions = 0;
+	numOfStateExpansions = 0;
+	maxQLength = 1;
+	if (processCount == 0u) processCount = std::thread::hardware_concurrency();
+	if (processCount == 0u) processCount = 1u;
+
+	//Wall clock time because clock() only counts the time of this process
+	const auto startTime = std::chrono::steady_clock::now();
+
+	try
+	{
+
+		for (size_t i = 0; i != goalState.size(); ++i)
+		{
+			if (goalState[i] == '0')
+			{
+				goal.tiles[i] = 0;
+				goal.emptyPos = i;
+			}
+			else
+			{
+				goal.tiles[i] = goalState[i] - '0';
+			}
+		}
+
+		for (size_t i = 0; i != initialState.size(); ++i)
+		{
+			if (initialState[i] == '0')
+			{
+				initial.tiles[i] = 0;
+				initial.emptyPos = i;
+			}
+			else
+			{
+				initial.tiles[i] = initialState[i] - '0';
+			}
+		}
+
+		//Any tables the heuristic needs are built here so every worker starts with them
+		const unsigned int initialHeuristic = heuristicValueFromScratch<heuristic>(initial, goal);
+		if (!isSolvable(initial, goal))
+		{
+			actualRunningTime = std::chrono::duration<float>(std::chrono::steady_clock::now() - startTime).count();
+			return "";
+		}
+
+		//The coordinator is process processCount. descriptors[i * processes + j] is the end of the socket process i uses to talk to process j.
+		const unsigned int processes = processCount + 1u;
+		std::unique_ptr<int[]> descriptors(new int[processes * processes]);
+		for (unsigned int i = 0u; i != processes * processes; ++i)
+		{
+			descriptors[i] = -1;
+		}
+		bool failed = false;
+		for (unsigned int i = 0u; i != processes && !failed; ++i)
+		{
+			for (unsigned int j = i + 1u; j != processes && !failed; ++j)
+			{
+				int pair[2];
+				failed = !createSocketPair(pair);
+				if (failed) break;
+				descriptors[i * processes + j] = pair[0];
+				descriptors[j * processes + i] = pair[1];
+			}
+		}
+
+		//Each process only keeps its own ends so a process that goes away is seen as a closed socket by the others
+		auto keepEnds = [&](unsigned int process, std::unique_ptr<std::unique_ptr<SocketChannel>[]>& channels)
+		{
+			for (unsigned int i = 0u; i != processes * processes; ++i)
+			{
+				if (descriptors[i] == -1) continue;
+				if (i / processes == process)
+				{
+					channels[i % processes].reset(new SocketChannel(descriptors[i]));
+				}
+				else
+				{
+					closeDescriptor(descriptors[i]);
+				}
+			}
+		};
+
+		std::cout.flush();
+		Vector<long> workerIds;
+		for (unsigned int worker = 0u; worker != processCount && !failed; ++worker)
+		{
+			const long processId = startWorkerProcess();
+			if (processId == 0)
+			{
+				//Nothing may get back to the caller from a worker, or the worker would carry on as a second copy of the program
+				try
+				{
+					std::unique_ptr<std::unique_ptr<SocketChannel>[]> channels(new std::unique_ptr<SocketChannel>[processes]);
+					keepEnds(worker, channels);
+					std::unique_ptr<SocketChannel*[]> peers(new SocketChannel*[processCount]);
+					for (unsigned int i = 0u; i != processCount; ++i)
+					{
+						peers[i] = channels[i].get();
+					}
+					distributedAStarWorker<heuristic>(worker, processCount, peers.get(), *channels[processCount], goal);
+				}
+				catch (...)
+				{
+				}
+				exitWorkerProcess();
+			}
+			if (processId == -1)
+			{
+				failed = true;
+				break;
+			}
+			workerIds.push_back(processId);
+		}
+
+		std::unique_ptr<std::unique_ptr<SocketChannel>[]> channels(new std::unique_ptr<SocketChannel>[processes]);
+		keepEnds(processCount, channels);
+		std::unique_ptr<SocketChannel*[]> workers(new SocketChannel*[processCount]);
+		for (unsigned int i = 0u; i != processCount; ++i)
+		{
+			workers[i] = channels[i].get();
+		}
+
+		unsigned int incumbentF = infinity;
+		bool outOfMemory = false;
+		bool stopped = false;
+		if (!failed)
+		{
+			const uint64_t initialKey = packState(initial);
+			workers[distributedOwner(initialKey, processCount)]->send(ChannelMessage{ childMessage, noDirection, initialKey, 0u, initialHeuristic });
+
+			//The coordinator has sent the initial state which no worker counts as sent
+			const uint64_t coordinatorSent = 1u;
+			uint64_t lastSent = std::numeric_limits<uint64_t>::max(), lastReceived = std::numeric_limits<uint64_t>::max();
+			uint64_t roundSent = 0u, roundReceived = 0u;
+			unsigned int replies = 0u;
+			bool roundStarted = false, allIdle = true;
+			while (!failed && !outOfMemory)
+			{
+				for (unsigned int i = 0u; i != processCount; ++i)
+				{
+					failed = failed || !workers[i]->flush();
+				}
+				waitForChannels(workers.get(), processCount, 10);
+				for (unsigned int i = 0u; i != processCount && !failed; ++i)
+				{
+					if (!workers[i]->receive())
+					{
+						failed = true;
+						break;
+					}
+					ChannelMessage message;
+					while (workers[i]->next(message))
+					{
+						if (message.type == solutionMessage && message.value < incumbentF)
+						{
+							incumbentF = message.value;
+							for (unsigned int j = 0u; j != processCount; ++j)
+							{
+								workers[j]->send(ChannelMessage{ incumbentMessage, incumbentF, 0u, 0u, 0u });
+							}
+						}
+						else if (message.type == statusMessage)
+						{
+							++replies;
+							allIdle = allIdle && message.value != 0u;
+							roundSent += message.first;
+							roundReceived += message.second;
+						}
+						else if (message.type == outOfMemoryMessage)
+						{
+							outOfMemory = true;
+						}
+					}
+				}
+				if (failed || outOfMemory) break;
+				//Looked at every time round as the coordinator expands nothing itself
+				if (cancellation != nullptr && cancellation->isCancelled())
+				{
+					stopped = true;
+					break;
+				}
+
+				if (!roundStarted)
+				{
+					for (unsigned int i = 0u; i != processCount; ++i)
+					{
+						workers[i]->send(ChannelMessage{ statusRequestMessage, 0u, 0u, 0u, 0u });
+					}
+					roundStarted = true;
+					replies = 0u;
+					allIdle = true;
+					roundSent = 0u;
+					roundReceived = 0u;
+				}
+				else if (replies == processCount)
+				{
+					if (allIdle && roundSent + coordinatorSent == roundReceived && roundSent == lastSent && roundReceived == lastReceived) break;
+					lastSent = roundSent;
+					lastReceived = roundReceived;
+					roundStarted = false;
+				}
+			}
+		}
+
+		//Unless the search was stopped every worker is idle, so the only messages now are the answers to the coordinator.
+		//Returns false if the worker has gone without answering.
+		auto awaitReply = [&](unsigned int worker, uint32_t replyType, ChannelMessage& reply)
+		{
+			SocketChannel* const channel = workers[worker];
+			bool open = true;
+			while (open)
+			{
+				open = channel->flush();
+				waitForChannels(&channel, 1u, 10);
+				open = channel->receive() && open;
+				while (channel->next(reply))
+				{
+					if (reply.type == replyType) return true;
+				}
+			}
+			return false;
+		};
+		auto request = [&](unsigned int worker, const ChannelMessage& message, uint32_t replyType, ChannelMessage& reply)
+		{
+			workers[worker]->send(message);
+			failed = failed || !awaitReply(worker, replyType, reply);
+		};
+
+		if (!failed && !outOfMemory && !stopped && incumbentF != infinity)
+		{
+			const char moves[4] = { 'U', 'R', 'D', 'L' };
+			Map<width, height> state = goal;
+			while (state != initial && !failed)
+			{
+				const uint64_t key = packState(state);
+				ChannelMessage reply;
+				request(distributedOwner(key, processCount), ChannelMessage{ traceMessage, 0u, key, 0u, 0u }, traceReplyMessage, reply);
+				if (failed || reply.value == noDirection)
+				{
+					failed = true;
+					break;
+				}
+				path.push_back(moves[reply.value]);
+				//Undo the move by moving the empty tile the opposite way
+				const size_t emptyPos = state.emptyPos;
+				const size_t oldPositions[4] = { emptyPos + width, emptyPos - 1u, emptyPos - width, emptyPos + 1u };
+				state.tiles[emptyPos] = state.tiles[oldPositions[reply.value]];
+				state.tiles[oldPositions[reply.value]] = 0;
+				state.emptyPos = oldPositions[reply.value];
+			}
+			std::reverse(path.begin(), path.end());
+		}
+
+		if (!failed)
+		{
+			//Workers stopped in the middle of the search could still be sending each other children, so every worker is told to stop before
+			//any is waited for. One that has already gone because a worker it was sending to stopped first can't report its counts.
+			for (unsigned int i = 0u; i != processCount; ++i)
+			{
+				workers[i]->send(ChannelMessage{ stopMessage, 0u, 0u, 0u, 0u });
+			}
+			for (unsigned int i = 0u; i != processCount; ++i)
+			{
+				ChannelMessage statistics;
+				if (!awaitReply(i, statisticsMessage, statistics))
+				{
+					failed = !stopped;
+					if (failed) break;
+					continue;
+				}
+				numOfStateExpansions += (int)statistics.value;
+				//The open lists are separate so their largest sizes are added up
+				maxQLength += (int)statistics.state;
+				numOfDeletionsFromMiddleOfHeap += (int)(statistics.first & 0xFFFFFFFFu);
+				numOfLocalLoopsAvoided += (int)(statistics.first >> 32u);
+				numOfAttemptedNodeReExpansions += (int)statistics.second;
+			}
+			maxQLength -= 1;
+		}
+
+		//Closing the sockets stops any worker still running
+		channels.reset();
+		for (size_t i = 0u; i != workerIds.size(); ++i)
+		{
+			waitForWorkerProcess(workerIds[i]);
+		}
+		if (outOfMemory) throw std::bad_alloc();
+		if (stopped)
+		{
+			path = stoppedPath(cancellation);
+		}
+		else if (failed || incumbentF == infinity)
+		{
+			path = "";
+		}
+
+	}
+	catch (std::bad_alloc)
+	{
+		path = "OOM";
+	}
+
+	actualRunningTime = std::chrono::duration<float>(std::chrono::steady_clock::now() - startTime).count();
+
+	return path;
+#else
+	return hashDistributedAStar<heuristic>(initialState, goalState, numOfStateExpansions, maxQLength, actualRunningTime,
+		numOfDeletionsFromMiddleOfHeap, numOfLocalLoopsAvoided, numOfAttemptedNodeReExpansions, processCount, cancellation);
+#endif
+}
+
+string distributedAStar(string const& initialState, string const& goalState, int &numOfStateExpansions, int& maxQLength, float &actualRunningTime,
+	int &numOfDeletionsFromMiddleOfHeap, int &numOfLocalLoopsAvoided, int &numOfAttemptedNodeReExpansions, heuristicFunction heuristic, unsigned int processCount,
+	const CancellationToken* cancellation){
+
+	if (heuristic == heuristicFunction::manhattanDistance)
+	{
+		return distributedAStar<manhattanDistance>(initialState, goalState, numOfStateExpansions, maxQLength, actualRunningTime,
+			numOfDeletionsFromMiddleOfHeap, numOfLocalLoopsAvoided, numOfAttemptedNodeReExpansions, processCount, cancellation);
+	}
+	else if (heuristic == heuristicFunction::linearConflict)
+	{
+		return distributedAStar<linearConflict>(initialState, goalState, numOfStateExpansions, maxQLength, actualRunningTime,
+			numOfDeletionsFromMiddleOfHeap, numOfLocalLoopsAvoided, numOfAttemptedNodeReExpansions, processCount, cancellation);
+	}
+	else if (heuristic == heuristicFunction::walkingDistance)
+	{
+		return distributedAStar<walkingDistance>(initialState, goalState, numOfStateExpansions, maxQLength, actualRunningTime,
+			numOfDeletionsFromMiddleOfHeap, numOfLocalLoopsAvoided, numOfAttemptedNodeReExpansions, processCount, cancellation);
+	}
+	else if (heuristic == heuristicFunction::patternDatabase)
+	{
+		return distributedAStar<patternDatabase>(initialState, goalState, numOfStateExpansions, maxQLength, actualRunningTime,
+			numOfDeletionsFromMiddleOfHeap, numOfLocalLoopsAvoided, numOfAttemptedNodeReExpansions, processCount, cancellation);
+	}
+	else
+	{
+		return distributedAStar<misplacedTiles>(initialState, goalState, numOfStateExpansions, maxQLength, actualRunningTime,
+			numOfDeletionsFromMiddleOfHeap, numOfLocalLoopsAvoided, numOfAttemptedNodeReExpansions, processCount, cancellation);
+	}
+}
+
+/*
+* Moves the empty tile of the state stored in node to newPos without copying the state and updates its heuristic.
+*/
+template<heuristicFunction heuristic, class Map, class Goal>
+void makeMoveInPlace(ListNode<Map>& node, Goal& goal, size_t newPos)
+{
+	size_t oldPos = node.data.emptyPos;
+	node.data.tiles[oldPos] = node.data.tiles[newPos];
+	node.data.tiles[newPos] = 0;
+	node.data.emptyPos = newPos;
+	calculateHeuristic<heuristic>(&node, node.data, goal, (unsigned int)oldPos, (unsigned int)newPos);
+}
+
+/*
+* Reverses makeMoveInPlace given the position of the empty tile and the heuristic values from before the move.
+*/
+template<class Map, class State>
+void undoMoveInPlace(ListNode<Map>& node, size_t oldPos, unsigned int oldF, unsigned int oldG, const State& oldHeuristicState)
+{
+	size_t newPos = node.data.emptyPos;
+	node.data.tiles[newPos] = node.data.tiles[oldPos];
+	node.data.tiles[oldPos] = 0;
+	node.data.emptyPos = oldPos;
+	node.data.f = oldF;
+	node.data.g = oldG;
+	static_cast<State&>(node.data) = oldHeuristicState;
+}
+
+/*
+* Stores the state of the puzzle with the values of a chain of heuristics, cheapest first, for lazy A*.
+* Only the first evaluatedHeuristics values and heuristic states are known. f is the depth plus the largest known value.
+* superseded is set when a shorter path to the state is found so the copy left in the open list can be skipped.
+*/
+template<size_t width, size_t height, heuristicFunction... heuristics>
+struct MapWithHeuristics : Map<width, height>, HeuristicState<heuristics>...
+{
+	constexpr static size_t heuristicCount = sizeof...(heuristics);
+	unsigned int depth;
+	unsigned int f;
+	unsigned char heuristicValues[heuristicCount];
+	unsigned char evaluatedHeuristics;
+	bool superseded;
+};
+
+template<heuristicFunction... heuristics>
+struct HeuristicChain
+{
+	template<class State, class Goal>
+	static void initialize(State& /*state*/, Goal& /*goal*/, size_t /*index*/) {}
+
+	template<class State, class Goal>
+	static void evaluate(ListNode<State>& /*node*/, Goal& /*goal*/, size_t /*index*/) {}
+};
+
+/*
+* Picks the heuristic of a chain to work on by its index.
+*/
+template<heuristicFunction heuristic, heuristicFunction... rest>
+struct HeuristicChain<heuristic, rest...>
+{
+	static_assert(isConsistent(heuristic), "Lazy A* doesn't reopen states so every heuristic must be consistent");
+
+	template<class State, class Goal>
+	static void initialize(State& state, Goal& goal, size_t index)
+	{
+		initializeHeuristic<heuristic>(state, goal);
+		state.heuristicValues[index] = (unsigned char)heuristicValue<heuristic>(state, goal);
+		HeuristicChain<rest...>::initialize(state, goal, index + 1u);
+	}
+
+	/*
+	* Calculates the value of heuristic number index for the state in node from the fully evaluated state it was reached from.
+	*/
+	template<class State, class Goal>
+	static void evaluate(ListNode<State>& node, Goal& goal, size_t index)
+	{
+		if (index != 0u)
+		{
+			HeuristicChain<rest...>::evaluate(node, goal, index - 1u);
+			return;
+		}
+		constexpr size_t width = State::width, height = State::height;
+		constexpr size_t valueIndex = State::heuristicCount - 1u - sizeof...(rest);
+		const State& parent = node.next->data;
+		//Single heuristic searches only track how far the value has moved, so starting from the parent's value from scratch gives the
+		//child's value from scratch
+		ListNode<MapWithHuristic<width, height, char, heuristic>> scratch;
+		static_cast<Map<width, height>&>(scratch.data) = parent;
+		static_cast<HeuristicState<heuristic>&>(scratch.data) = parent;
+		scratch.data.g = parent.heuristicValues[valueIndex];
+		scratch.data.f = 0u;
+		makeMoveInPlace<heuristic>(scratch, goal, node.data.emptyPos);
+		node.data.heuristicValues[valueIndex] = (unsigned char)scratch.data.g;
+		static_cast<HeuristicState<heuristic>&>(node.data) = scratch.data;
+	}
+};
+/*
+* Adds a child of the current state to the open list of lazy A* with only the cheapest heuristic evaluated.
+*/
+template<class Chain, class Queue, class Cache, class Map, class Goal, class Allocator>
+void expandLazyAStar(Map& currentState, ListNode<Map>* currentPath, size_t newPos, size_t oldPos, Queue& posiblePaths, Cache& cache,
+	Goal& goal, Allocator& allocator, int& numOfDeletionsFromMiddleOfHeap, int& numOfAttemptedNodeReExpansions)
+{
+	ListNode<Map>* currentNode = (ListNode<Map>*)allocator.getNext();
+	new(currentNode) ListNode<Map>{ currentState, currentPath };
+	currentNode->data.emptyPos = newPos;
+	currentNode->data.tiles[oldPos] = currentNode->data.tiles[currentNode->data.emptyPos];
+	currentNode->data.tiles[currentNode->data.emptyPos] = 0;
+	currentNode->data.depth = currentState.depth + 1u;
+
+	auto cachedState = cache.find(currentNode);
+	if (cachedState != cache.end() && (*cachedState)->data.depth <= currentNode->data.depth)
+	{
+		currentNode->~ListNode<Map>();
+		allocator.replaceLast();
+		++numOfAttemptedNodeReExpansions;
+		return;
+	}
+
+	Chain::evaluate(*currentNode, goal, 0u);
+	currentNode->data.evaluatedHeuristics = 1u;
+	currentNode->data.f = currentNode->data.depth + currentNode->data.heuristicValues[0];
+	currentNode->data.superseded = false;
+	if (cachedState != cache.end())
+	{
+		(*cachedState)->data.superseded = true;
+		*cachedState = currentNode;
+		++numOfDeletionsFromMiddleOfHeap;
+	}
+	else
+	{
+		cache.insert(currentNode);
+	}
+	posiblePaths.push(currentNode);
+}
+
+/*
+* A* that only evaluates expensive heuristics for states that reach the top of the open list. Children are added with the first, cheapest
+* heuristic of the chain. When a state reaches the top the next heuristic is evaluated and, if that raises its f value, it goes back
+* into the open list. Only states with every heuristic evaluated are expanded, so most generated states never pay for the expensive ones.
+*/
+template<heuristicFunction... heuristics>
+string lazyAStar_ExpandedList(string const& initialState, string const& goalState, int &numOfStateExpansions, int& maxQLength, float &actualRunningTime,
+	int &numOfDeletionsFromMiddleOfHeap, int &numOfLocalLoopsAvoided, int &numOfAttemptedNodeReExpansions,
+	const CancellationToken* cancellation)
+{
+	string path;
+	clock_t startTime;
+
+	constexpr size_t width = 3, height = 3;
+	using Map_t = MapWithHeuristics<width, height, heuristics...>;
+	using Chain = HeuristicChain<heuristics...>;
+	Map<width, height> goal;
+	PriorityQueue<ListNode<Map_t>*, Vector<ListNode<Map_t>*>, GreaterHeuistic<Map_t>> posiblePaths;
+	HashMap<ListNode<Map_t>*, ListNodeHasher<Map_t, 10>, ListNodeEqualityTester<Map_t>> cache;
+	ListNode<Map_t>* currentNode;
+	StackSlabAllocator<sizeof(ListNode<Map_t>), alignof(ListNode<Map_t>), (sizeof(ListNode<Map_t>) + sizeof(void*) > 204u ? 20u :
+		(4096u - sizeof(void*)) / sizeof(ListNode<Map_t>) * sizeof(ListNode<Map_t>))> allocator;
+
+	numOfDeletionsFromMiddleOfHeap = 0;
+	numOfLocalLoopsAvoided = 0;
+	numOfAttemptedNodeReExpansions = 0;
+	numOfStateExpansions = 0;
+
+	startTime = clock();
+
+	try
+	{
+
+		for (size_t i = 0; i != goalState.size(); ++i)
+		{
+			if (goalState[i] == '0')
+			{
+				goal.tiles[i] = 0;
+				goal.emptyPos = i;
+			}
+			else
+			{
+				goal.tiles[i] = goalState[i] - '0';
+			}
+		}
+
+		currentNode = (ListNode<Map_t>*)allocator.getNext();
+		new(currentNode) ListNode<Map_t>{ Map_t(), nullptr };
+		for (size_t i = 0; i != initialState.size(); ++i)
+		{
+			if (initialState[i] == '0')
+			{
+				currentNode->data.tiles[i] = 0;
+				currentNode->data.emptyPos = i;
+			}
+			else
+			{
+				currentNode->data.tiles[i] = initialState[i] - '0';
+			}
+		}
+
+		Chain::initialize(currentNode->data, goal, 0u);
+		currentNode->data.depth = 0u;
+		currentNode->data.f = 0u;
+		for (const auto value : currentNode->data.heuristicValues)
+		{
+			if (value > currentNode->data.f) currentNode->data.f = value;
+		}
+		currentNode->data.evaluatedHeuristics = (unsigned char)Map_t::heuristicCount;
+		currentNode->data.superseded = false;
+
+		posiblePaths.push(currentNode);
+		cache.insert(currentNode);
+		maxQLength = 1;
+		bool goalFound = false;
+		bool cancelled = false;
+
+		while (!posiblePaths.empty())
+		{
+			if (shouldStop(cancellation, numOfStateExpansions))
+			{
+				cancelled = true;
+				break;
+			}
+			ListNode<Map_t>* currentPath = posiblePaths.top();
+			Map_t& currentState = currentPath->data;
+			if (currentState == goal)
+			{
+				goalFound = true;
+				break;
+			}
+			posiblePaths.pop();
+			if (currentState.superseded) continue;
+
+			//A state whose f value doesn't change is still at the top so it can go straight on to the next heuristic
+			const unsigned int oldF = currentState.f;
+			while (currentState.evaluatedHeuristics != Map_t::heuristicCount && currentState.f == oldF)
+			{
+				Chain::evaluate(*currentPath, goal, currentState.evaluatedHeuristics);
+				const unsigned int value = currentState.heuristicValues[currentState.evaluatedHeuristics];
+				++currentState.evaluatedHeuristics;
+				if (currentState.depth + value > currentState.f) currentState.f = currentState.depth + value;
+			}
+			if (currentState.f != oldF)
+			{
+				posiblePaths.push(currentPath);
+				continue;
+			}
+
+			//expand path
+			size_t emptyPos = currentState.emptyPos;
+			size_t x = emptyPos % width;
+			size_t y = emptyPos / width;
+			//Moving the empty tile back to where it just came from would only recreate the parent state
+			size_t parentPos = currentPath->next != nullptr ? currentPath->next->data.emptyPos : width * height;
+			if (y != 0u && emptyPos - width != parentPos)
+			{
+				expandLazyAStar<Chain>(currentState, currentPath, emptyPos - width, emptyPos, posiblePaths, cache, goal, allocator,
+					numOfDeletionsFromMiddleOfHeap, numOfAttemptedNodeReExpansions);
+			}
+			if (x != width - 1u && emptyPos + 1u != parentPos)
+			{
+				expandLazyAStar<Chain>(currentState, currentPath, emptyPos + 1u, emptyPos, posiblePaths, cache, goal, allocator,
+					numOfDeletionsFromMiddleOfHeap, numOfAttemptedNodeReExpansions);
+			}
+			if (y != height - 1u && emptyPos + width != parentPos)
+			{
+				expandLazyAStar<Chain>(currentState, currentPath, emptyPos + width, emptyPos, posiblePaths, cache, goal, allocator,
+					numOfDeletionsFromMiddleOfHeap, numOfAttemptedNodeReExpansions);
+			}
+			if (x != 0u && emptyPos - 1u != parentPos)
+			{
+				expandLazyAStar<Chain>(currentState, currentPath, emptyPos - 1u, emptyPos, posiblePaths, cache, goal, allocator,
+					numOfDeletionsFromMiddleOfHeap, numOfAttemptedNodeReExpansions);
+			}
+
+			if (currentPath->next != nullptr)
+			{
+				++numOfLocalLoopsAvoided;
+			}
+			if (posiblePaths.size() > (unsigned int)maxQLength)
+			{
+				maxQLength = (int)posiblePaths.size();
+			}
+			++numOfStateExpansions;
+		}
+
+		if (goalFound)
+		{
+			path = packPath(posiblePaths.top());
+		}
+		else if (cancelled)
+		{
+			path = stoppedPath(cancellation);
+		}
+		else
+		{
+			path = "";
+		}
+
+	}
+	catch (std::bad_alloc)
+	{
+		path = "OOM";
+	}
+
+	actualRunningTime = ((float)(clock() - startTime) / CLOCKS_PER_SEC);
+
+	return path;
+}
+
+string lazyAStar_ExpandedList(string const& initialState, string const& goalState, int &numOfStateExpansions, int& maxQLength, float &actualRunningTime,
+	int &numOfDeletionsFromMiddleOfHeap, int &numOfLocalLoopsAvoided, int &numOfAttemptedNodeReExpansions, heuristicFunction heuristic,
+	const CancellationToken* cancellation){
+
+	if (heuristic == heuristicFunction::linearConflict)
+	{
+		return lazyAStar_ExpandedList<manhattanDistance, linearConflict>(initialState, goalState, numOfStateExpansions, maxQLength,
+			actualRunningTime, numOfDeletionsFromMiddleOfHeap, numOfLocalLoopsAvoided, numOfAttemptedNodeReExpansions, cancellation);
+	}
+	else if (heuristic == heuristicFunction::walkingDistance)
+	{
+		return lazyAStar_ExpandedList<manhattanDistance, walkingDistance>(initialState, goalState, numOfStateExpansions, maxQLength,
+			actualRunningTime, numOfDeletionsFromMiddleOfHeap, numOfLocalLoopsAvoided, numOfAttemptedNodeReExpansions, cancellation);
+	}
+	else if (heuristic == heuristicFunction::patternDatabase)
+	{
+		return lazyAStar_ExpandedList<manhattanDistance, linearConflict, patternDatabase>(initialState, goalState, numOfStateExpansions, maxQLength,
+			actualRunningTime, numOfDeletionsFromMiddleOfHeap, numOfLocalLoopsAvoided, numOfAttemptedNodeReExpansions, cancellation);
+	}
+	else
+	{
+		return lazyAStar_ExpandedList<misplacedTiles, manhattanDistance>(initialState, goalState, numOfStateExpansions, maxQLength,
+			actualRunningTime, numOfDeletionsFromMiddleOfHeap, numOfLocalLoopsAvoided, numOfAttemptedNodeReExpansions, cancellation);
+	}
+}
+
+/*
+* How much moving tile from fromPos to toPos changes a heuristic, without making the move. Only heuristics that depend on each tile on its
+* own can be worked out like this.
+*/
+template<heuristicFunction heuristic, class Goal, class TileType>
+typename std::enable_if<heuristic == misplacedTiles, int>::type moveHeuristicChange(const Goal& goal, TileType tile, size_t fromPos, size_t toPos)
+{
+	return (goal.tiles[fromPos] == tile ? 1 : 0) - (goal.tiles[toPos] == tile ? 1 : 0);
+}
+
+template<heuristicFunction heuristic, class Goal, class TileType>
+typename std::enable_if<heuristic == manhattanDistance, int>::type moveHeuristicChange(const Goal& goal, TileType tile, size_t fromPos, size_t toPos)
+{
+	constexpr size_t width = Goal::width;
+	const size_t goalPos = goalPosition(goal, tile);
+	const int fromDistance = std::abs((int)(fromPos % width) - (int)(goalPos % width)) + std::abs((int)(fromPos / width) - (int)(goalPos / width));
+	const int toDistance = std::abs((int)(toPos % width) - (int)(goalPos % width)) + std::abs((int)(toPos / width) - (int)(goalPos / width));
+	return toDistance - fromDistance;
+}
+
+/*
+* The operator table of partial expansion A*: the change in f of every move of the empty tile from every position for every tile it can
+* swap with. A move always adds one to the depth so the change is one plus the change in the heuristic.
+*/
+template<heuristicFunction heuristic, size_t width, size_t height>
+struct PartialExpansionTable
+{
+	constexpr static size_t tileCount = width * height;
+	constexpr static unsigned char cantMove = std::numeric_limits<unsigned char>::max();
+	unsigned char fChanges[tileCount][4][tileCount];
+
+	explicit PartialExpansionTable(const Map<width, height>& goal)
+	{
+		for (size_t emptyPos = 0u; emptyPos != tileCount; ++emptyPos)
+		{
+			const size_t newPositions[4] = { emptyPos - width, emptyPos + 1u, emptyPos + width, emptyPos - 1u };
+			const bool canMove[4] = { emptyPos / width != 0u, emptyPos % width != width - 1u, emptyPos / width != height - 1u, emptyPos % width != 0u };
+			for (size_t direction = 0u; direction != 4u; ++direction)
+			{
+				for (size_t tile = 0u; tile != tileCount; ++tile)
+				{
+					fChanges[emptyPos][direction][tile] = canMove[direction] && tile != 0u ?
+						(unsigned char)(1 + moveHeuristicChange<heuristic>(goal, (char)tile, newPositions[direction], emptyPos)) : cantMove;
+				}
+			}
+		}
+	}
+};
+
+/*
+* Stores a state for partial expansion A*. The state is queued by storedF, its own f value plus the smallest change in f of the children
+* it hasn't generated yet.
+*/
+template<size_t width, size_t height, heuristicFunction heuristic>
+struct MapWithStoredF : MapWithHuristic<width, height, char, heuristic>
+{
+	unsigned int storedF;
+	bool superseded;
+};
+
+template<class Map_t>
+struct GreaterStoredF
+{
+	constexpr bool operator()(const ListNode<Map_t>* value1, const ListNode<Map_t>* value2) const
+	{
+		return value1->data.storedF > value2->data.storedF;
+	}
+};
+
+/*
+* Adds a child of the current state to the open list of partial expansion A* unless a path to it at least as short has already been found.
+*/
+template<heuristicFunction heuristic, class Queue, class Cache, class Map, class Goal, class Allocator>
+void expandPartialExpansionAStar(Map& currentState, ListNode<Map>* currentPath, size_t newPos, size_t oldPos, Queue& posiblePaths, Cache& cache,
+	Goal& goal, Allocator& allocator, int& numOfDeletionsFromMiddleOfHeap, int& numOfAttemptedNodeReExpansions)
+{
+	ListNode<Map>* currentNode = (ListNode<Map>*)allocator.getNext();
+	new(currentNode) ListNode<Map>{ currentState, currentPath };
+	currentNode->data.emptyPos = newPos;
+	currentNode->data.tiles[oldPos] = currentNode->data.tiles[currentNode->data.emptyPos];
+	currentNode->data.tiles[currentNode->data.emptyPos] = 0;
+
+	//The number of moves to a state is f - g
+	auto cachedState = cache.find(currentNode);
+	if (cachedState != cache.end() && (*cachedState)->data.f - (*cachedState)->data.g <= currentState.f - currentState.g + 1u)
+	{
+		currentNode->~ListNode<Map>();
+		allocator.replaceLast();
+		++numOfAttemptedNodeReExpansions;
+		return;
+	}
+
+	calculateHeuristic<heuristic>(currentNode, currentState, goal, (unsigned int)oldPos, (unsigned int)newPos);
+	currentNode->data.storedF = currentNode->data.f;
+	currentNode->data.superseded = false;
+	if (cachedState != cache.end())
+	{
+		(*cachedState)->data.superseded = true;
+		*cachedState = currentNode;
+		++numOfDeletionsFromMiddleOfHeap;
+	}
+	else
+	{
+		cache.insert(currentNode);
+	}
+	posiblePaths.push(currentNode);
+}
+
+/*
+* Enhanced partial expansion A*. Expanding a state only generates the children whose f value equals the state's stored f value, found from
+* the operator table without generating the others. The state then goes back into the open list with its stored f raised to the next
+* larger f value of its children, or is closed if there are none. Children whose f value is over the cost of the solution are never
+* generated so the open list stays much smaller.
+*/
+template<heuristicFunction heuristic>
+string partialExpansionAStar_ExpandedList(string const& initialState, string const& goalState, int &numOfStateExpansions, int& maxQLength, float &actualRunningTime,
+	int &numOfDeletionsFromMiddleOfHeap, int &numOfLocalLoopsAvoided, int &numOfAttemptedNodeReExpansions,
+	const CancellationToken* cancellation)
+{
+	string path;
+	clock_t startTime;
+
+	constexpr size_t width = 3, height = 3;
+	using Map_t = MapWithStoredF<width, height, heuristic>;
+	using Table = PartialExpansionTable<heuristic, width, height>;
+	Map<width, height> goal;
+	PriorityQueue<ListNode<Map_t>*, Vector<ListNode<Map_t>*>, GreaterStoredF<Map_t>> posiblePaths;
+	HashMap<ListNode<Map_t>*, ListNodeHasher<Map_t, 10>, ListNodeEqualityTester<Map_t>> cache;
+	ListNode<Map_t>* currentNode;
+	StackSlabAllocator<sizeof(ListNode<Map_t>), alignof(ListNode<Map_t>), (sizeof(ListNode<Map_t>) + sizeof(void*) > 204u ? 20u :
+		(4096u - sizeof(void*)) / sizeof(ListNode<Map_t>) * sizeof(ListNode<Map_t>))> allocator;
+
+	numOfDeletionsFromMiddleOfHeap = 0;
+	numOfLocalLoopsAvoided = 0;
+	numOfAttemptedNodeReExpansions = 0;
+	numOfStateExpansions = 0;
+
+	startTime = clock();
+
+	try
+	{
+
+		for (size_t i = 0; i != goalState.size(); ++i)
+		{
+			if (goalState[i] == '0')
+			{
+				goal.tiles[i] = 0;
+				goal.emptyPos = i;
+			}
+			else
+			{
+				goal.tiles[i] = goalState[i] - '0';
+			}
+		}
+		const Table table(goal);
+
+		currentNode = (ListNode<Map_t>*)allocator.getNext();
+		new(currentNode) ListNode<Map_t>{ Map_t(), nullptr };
+		for (size_t i = 0; i != initialState.size(); ++i)
+		{
+			if (initialState[i] == '0')
+			{
+				currentNode->data.tiles[i] = 0;
+				currentNode->data.emptyPos = i;
+			}
+			else
+			{
+				currentNode->data.tiles[i] = initialState[i] - '0';
+			}
+		}
+
+		initializeHeuristic<heuristic>(currentNode->data, goal);
+		currentNode->data.storedF = currentNode->data.f;
+		currentNode->data.superseded = false;
+
+		posiblePaths.push(currentNode);
+		cache.insert(currentNode);
+		maxQLength = 1;
+		bool goalFound = false;
+		bool cancelled = false;
+
+		while (!posiblePaths.empty())
+		{
+			if (shouldStop(cancellation, numOfStateExpansions))
+			{
+				cancelled = true;
+				break;
+			}
+			ListNode<Map_t>* currentPath = posiblePaths.top();
+			Map_t& currentState = currentPath->data;
+			if (currentState == goal)
+			{
+				goalFound = true;
+				break;
+			}
+			posiblePaths.pop();
+			if (currentState.superseded) continue;
+
+			size_t emptyPos = currentState.emptyPos;
+			//Moving the empty tile back to where it just came from would only recreate the parent state
+			size_t parentPos = currentPath->next != nullptr ? currentPath->next->data.emptyPos : width * height;
+			const size_t newPositions[4] = { emptyPos - width, emptyPos + 1u, emptyPos + width, emptyPos - 1u };
+			const unsigned int fChange = currentState.storedF - currentState.f;
+			unsigned int nextFChange = Table::cantMove;
+			for (size_t direction = 0u; direction != 4u; ++direction)
+			{
+				const unsigned int childFChange = table.fChanges[emptyPos][direction][(size_t)currentState.tiles[newPositions[direction] % (width * height)]];
+				if (childFChange == Table::cantMove || newPositions[direction] == parentPos) continue;
+				if (childFChange == fChange)
+				{
+					expandPartialExpansionAStar<heuristic>(currentState, currentPath, newPositions[direction], emptyPos, posiblePaths, cache, goal,
+						allocator, numOfDeletionsFromMiddleOfHeap, numOfAttemptedNodeReExpansions);
+				}
+				else if (childFChange > fChange && childFChange < nextFChange)
+				{
+					nextFChange = childFChange;
+				}
+			}
+			if (nextFChange != Table::cantMove)
+			{
+				currentState.storedF = currentState.f + nextFChange;
+				posiblePaths.push(currentPath);
+			}
+
+			if (currentPath->next != nullptr)
+			{
+				++numOfLocalLoopsAvoided;
+			}
+			if (posiblePaths.size() > (unsigned int)maxQLength)
+			{
+				maxQLength = (int)posiblePaths.size();
+			}
+			++numOfStateExpansions;
+		}
+
+		if (goalFound)
+		{
+			path = packPath(posiblePaths.top());
+		}
+		else if (cancelled)
+		{
+			path = stoppedPath(cancellation);
+		}
+		else
+		{
+			path = "";
+		}
+
+	}
+	catch (std::bad_alloc)
+	{
+		path = "OOM";
+	}
+
+	actualRunningTime = ((float)(clock() - startTime) / CLOCKS_PER_SEC);
+
+	return path;
+}
+
+string partialExpansionAStar_ExpandedList(string const& initialState, string const& goalState, int &numOfStateExpansions, int& maxQLength, float &actualRunningTime,
+	int &numOfDeletionsFromMiddleOfHeap, int &numOfLocalLoopsAvoided, int &numOfAttemptedNodeReExpansions, heuristicFunction heuristic,
+	const CancellationToken* cancellation){
+
+	if (heuristic == heuristicFunction::manhattanDistance)
+	{
+		return partialExpansionAStar_ExpandedList<manhattanDistance>(initialState, goalState, numOfStateExpansions, maxQLength, actualRunningTime,
+			numOfDeletionsFromMiddleOfHeap, numOfLocalLoopsAvoided, numOfAttemptedNodeReExpansions, cancellation);
+	}
+	else
+	{
+		return partialExpansionAStar_ExpandedList<misplacedTiles>(initialState, goalState, numOfStateExpansions, maxQLength, actualRunningTime,
+			numOfDeletionsFromMiddleOfHeap, numOfLocalLoopsAvoided, numOfAttemptedNodeReExpansions, cancellation);
+	}
+}
+
+/*
+* A move of the empty tile considered by recursive best-first search along with its backed-up f value.
+*/
+struct RecursiveBestFirstSearchChild
+{
+	size_t newPos;
+	unsigned int f;
+	unsigned int pruningState;
+	char move;
+};
+
+template<heuristicFunction heuristic, class Map, class Goal, class Automaton>
+void addRecursiveBestFirstSearchChild(ListNode<Map>& current, Goal& goal, size_t newPos, char move, size_t direction, unsigned int pruningState,
+	const Automaton& automaton, unsigned int backedUpF, const Perimeter<Map::width, Map::height>* perimeter, unsigned int initialHeuristic,
+	RecursiveBestFirstSearchChild* children, size_t& childCount)
+{
+	pruningState = automaton.next(pruningState, direction);
+	if (pruningState == Automaton::pruned) return;
+
+	size_t oldPos = current.data.emptyPos;
+	unsigned int oldF = current.data.f;
+	unsigned int oldG = current.data.g;
+	const HeuristicState<heuristic> oldHeuristicState = current.data;
+	makeMoveInPlace<heuristic>(current, goal, newPos);
+	if (perimeter != nullptr) usePerimeterDistance(current.data, *perimeter, initialHeuristic);
+	unsigned int f = current.data.f;
+	undoMoveInPlace(current, oldPos, oldF, oldG, oldHeuristicState);
+
+	//A child of a state that has already been searched inherits the backed-up f value of its parent
+	if (oldF < backedUpF && f < backedUpF)
+	{
+		f = backedUpF;
+	}
+	children[childCount] = RecursiveBestFirstSearchChild{ newPos, f, pruningState, move };
+	++childCount;
+}
+
+/*
+* Searches below the state stored in current in best-first order while the best f value stays within bound.
+* parentPos is the position the empty tile was in before the last move or width * height for the initial state.
+* pruningState is the state of the MovePruningAutomaton after the moves that lead to current.
+* Returns the new backed-up f value of current which is greater than bound unless the goal has been found.
+* Only the children of the states on the current path are stored so memory use is linear in the depth of the search.
+* If perimeter isn't null the search stops at states on it and finishes the path with the moves from there to the goal.
+* If cancellation isn't null the search sets cancelled and gives up once it is stopped, returning without finding the goal.
+*/
+template<heuristicFunction heuristic, class Map, class Goal, class Automaton>
+unsigned int recursiveBestFirstSearch(ListNode<Map>& current, size_t parentPos, unsigned int pruningState, unsigned int backedUpF, unsigned int bound,
+	Goal& goal, const Automaton& automaton, const Perimeter<Map::width, Map::height>* perimeter, unsigned int initialHeuristic, std::string& path,
+	bool& goalFound, const CancellationToken* cancellation, bool& cancelled, int& numOfStateExpansions, int& storedStates, int& maxQLength)
+{
+	constexpr size_t width = Map::width, height = Map::height;
+	constexpr unsigned int infinity = std::numeric_limits<unsigned int>::max();
+	if (perimeter != nullptr)
+	{
+		const unsigned int distance = perimeter->distance(current.data);
+		if (distance != Perimeter<width, height>::outside)
+		{
+			const unsigned int f = current.data.f - current.data.g + distance - initialHeuristic;
+			if (f <= bound)
+			{
+				goalFound = true;
+				perimeter->appendPath(current.data, path);
+			}
+			return f > backedUpF ? f : backedUpF;
+		}
+	}
+	else if (current.data == goal)
+	{
+		goalFound = true;
+		return backedUpF;
+	}
+
+	RecursiveBestFirstSearchChild children[4];
+	size_t childCount = 0u;
+	size_t emptyPos = current.data.emptyPos;
+	size_t x = emptyPos % width;
+	size_t y = emptyPos / width;
+	if (y != 0u && emptyPos - width != parentPos)
+	{
+		addRecursiveBestFirstSearchChild<heuristic>(current, goal, emptyPos - width, 'U', 0u, pruningState, automaton, backedUpF,
+			perimeter, initialHeuristic, children, childCount);
+	}
+	if (x != width - 1u && emptyPos + 1u != parentPos)
+	{
+		addRecursiveBestFirstSearchChild<heuristic>(current, goal, emptyPos + 1u, 'R', 1u, pruningState, automaton, backedUpF,
+			perimeter, initialHeuristic, children, childCount);
+	}
+	if (y != height - 1u && emptyPos + width != parentPos)
+	{
+		addRecursiveBestFirstSearchChild<heuristic>(current, goal, emptyPos + width, 'D', 2u, pruningState, automaton, backedUpF,
+			perimeter, initialHeuristic, children, childCount);
+	}
+	if (x != 0u && emptyPos - 1u != parentPos)
+	{
+		addRecursiveBestFirstSearchChild<heuristic>(current, goal, emptyPos - 1u, 'L', 3u, pruningState, automaton, backedUpF,
+			perimeter, initialHeuristic, children, childCount);
+	}
+	++numOfStateExpansions;
+	if (childCount == 0u) return infinity;
+	if (shouldStop(cancellation, numOfStateExpansions))
+	{
+		cancelled = true;
+		return infinity;
+	}
+
+	storedStates += (int)childCount;
+	if (storedStates > maxQLength)
+	{
+		maxQLength = storedStates;
+	}
+
+	while (true)
+	{
+		size_t best = 0u;
+		for (size_t i = 1u; i != childCount; ++i)
+		{
+			if (children[i].f < children[best].f) best = i;
+		}
+		if (children[best].f > bound || children[best].f == infinity)
+		{
+			storedStates -= (int)childCount;
+			return children[best].f;
+		}
+		unsigned int alternative = infinity;
+		for (size_t i = 0u; i != childCount; ++i)
+		{
+			if (i != best && children[i].f < alternative) alternative = children[i].f;
+		}
+
+		unsigned int oldF = current.data.f;
+		unsigned int oldG = current.data.g;
+		const HeuristicState<heuristic> oldHeuristicState = current.data;
+		makeMoveInPlace<heuristic>(current, goal, children[best].newPos);
+		path.push_back(children[best].move);
+		children[best].f = recursiveBestFirstSearch<heuristic>(current, emptyPos, children[best].pruningState, children[best].f,
+			alternative < bound ? alternative : bound, goal, automaton, perimeter, initialHeuristic, path, goalFound, cancellation, cancelled,
+			numOfStateExpansions, storedStates, maxQLength);
+		if (goalFound || cancelled)
+		{
+			storedStates -= (int)childCount;
+			return children[best].f;
+		}
+		path.pop_back();
+		undoMoveInPlace(current, emptyPos, oldF, oldG, oldHeuristicState);
+	}
+}
+
+template<heuristicFunction heuristic>
+string recursiveBestFirstSearch(string const& initialState, string const& goalState, int &numOfStateExpansions, int& maxQLength, float &actualRunningTime,
+	unsigned int perimeterDepth, const CancellationToken* cancellation)
+{
+	string path;
+	clock_t startTime;
+
+	constexpr size_t width = 3, height = 3;
+	using Map_t = MapWithHuristic<width, height, char, heuristic>;
+	Map<width, height> goal;
+	ListNode<Map_t> current{ Map_t(), nullptr };
+	int storedStates = 1;
+	const MovePruningAutomaton<width, height>& automaton = getMovePruningAutomaton<width, height>();
+
+	numOfStateExpansions = 0;
+	maxQLength = 1;
+
+	startTime = clock();
+
+	try
+	{
+
+		for (size_t i = 0; i != goalState.size(); ++i)
+		{
+			if (goalState[i] == '0')
+			{
+				goal.tiles[i] = 0;
+				goal.emptyPos = i;
+			}
+			else
+			{
+				goal.tiles[i] = goalState[i] - '0';
+			}
+		}
+
+		for (size_t i = 0; i != initialState.size(); ++i)
+		{
+			if (initialState[i] == '0')
+			{
+				current.data.tiles[i] = 0;
+				current.data.emptyPos = i;
+			}
+			else
+			{
+				current.data.tiles[i] = initialState[i] - '0';
+			}
+		}
+
+		initializeHeuristic<heuristic>(current.data, goal);
+		const std::shared_ptr<const Perimeter<width, height>> heldPerimeter = perimeterDepth != 0u ? getPerimeter(goal, perimeterDepth) : nullptr;
+		const Perimeter<width, height>* perimeter = heldPerimeter.get();
+		const unsigned int initialHeuristic = perimeter != nullptr ? heuristicValue<heuristic>(current.data, goal) : 0u;
+
+		//Recursive best-first search never runs out of memory so it would never return if the goal can't be reached
+		bool goalFound = false;
+		bool cancelled = false;
+		if (isSolvable(current.data, goal))
+		{
+			recursiveBestFirstSearch<heuristic>(current, width * height, automaton.start(current.data.emptyPos), current.data.f,
+				std::numeric_limits<unsigned int>::max() - 1u, goal, automaton, perimeter, initialHeuristic, path, goalFound, cancellation, cancelled,
+				numOfStateExpansions, storedStates, maxQLength);
+		}
+
+		if (!goalFound)
+		{
+			path = cancelled ? stoppedPath(cancellation) : "";
+		}
+	}
+	catch (std::bad_alloc)
+	{
+		path = "OOM";
+	}
+
+	actualRunningTime = ((float)(clock() - startTime) / CLOCKS_PER_SEC);
+
+	return path;
+}
+
+string recursiveBestFirstSearch(string const& initialState, string const& goalState, int &numOfStateExpansions, int& maxQLength, float &actualRunningTime,
+	heuristicFunction heuristic, unsigned int perimeterDepth,
+	const CancellationToken* cancellation){
+
+	if (heuristic == heuristicFunction::manhattanDistance)
+	{
+		return recursiveBestFirstSearch<manhattanDistance>(initialState, goalState, numOfStateExpansions, maxQLength, actualRunningTime, perimeterDepth, cancellation);
+	}
+	else if (heuristic == heuristicFunction::linearConflict)
+	{
+		return recursiveBestFirstSearch<linearConflict>(initialState, goalState, numOfStateExpansions, maxQLength, actualRunningTime, perimeterDepth, cancellation);
+	}
+	else if (heuristic == heuristicFunction::walkingDistance)
+	{
+		return recursiveBestFirstSearch<walkingDistance>(initialState, goalState, numOfStateExpansions, maxQLength, actualRunningTime, perimeterDepth, cancellation);
+	}
+	else if (heuristic == heuristicFunction::patternDatabase)
+	{
+		return recursiveBestFirstSearch<patternDatabase>(initialState, goalState, numOfStateExpansions, maxQLength, actualRunningTime, perimeterDepth, cancellation);
+	}
+	else
+	{
+		return recursiveBestFirstSearch<misplacedTiles>(initialState, goalState, numOfStateExpansions, maxQLength, actualRunningTime, perimeterDepth, cancellation);
+	}
+}
+
+/*
+* Adds a child of the current state to the now list of fringe search unless a path to it at least as short has already been found.
+* A worse path to the child that is still on the fringe is removed lazily by setting its f value to infinity.
+*/
+template<heuristicFunction heuristic, class Fringe, class Cache, class Map, class Goal, class Allocator>
+void expandFringe(Map& currentState, ListNode<Map>* currentPath, size_t newPos, size_t oldPos, Fringe& now, Cache& cache, Goal& goal,
+	Allocator& allocator)
+{
+	ListNode<Map>* currentNode = (ListNode<Map>*)allocator.getNext();
+	new(currentNode) ListNode<Map>{ currentState, currentPath };
+	currentNode->data.emptyPos = newPos;
+	currentNode->data.tiles[oldPos] = currentNode->data.tiles[currentNode->data.emptyPos];
+	currentNode->data.tiles[currentNode->data.emptyPos] = 0;
+	calculateHeuristic<heuristic>(currentNode, currentState, goal, (unsigned int)oldPos, (unsigned int)newPos);
+
+	auto cachedState = cache.find(currentNode);
+	if (cachedState != cache.end())
+	{
+		if ((*cachedState)->data.f <= currentNode->data.f)
+		{
+			currentNode->~ListNode<Map>();
+			allocator.replaceLast();
+			return;
+		}
+		(*cachedState)->data.f = std::numeric_limits<unsigned int>::max();
+		*cachedState = currentNode;
+	}
+	else
+	{
+		cache.insert(currentNode);
+	}
+	now.push_back(currentNode);
+}
+
+template<heuristicFunction heuristic>
+string fringeSearch(string const& initialState, string const& goalState, int &numOfStateExpansions, int& maxQLength, float &actualRunningTime,
+	const CancellationToken* cancellation)
+{
+	string path;
+	clock_t startTime;
+
+	constexpr size_t width = 3, height = 3;
+	constexpr unsigned int infinity = std::numeric_limits<unsigned int>::max();
+	using Map_t = MapWithHuristic<width, height, char, heuristic>;
+	Map<width, height> goal;
+	Vector<ListNode<Map_t>*> fringe1;
+	Vector<ListNode<Map_t>*> fringe2;
+	HashMap<ListNode<Map_t>*, ListNodeHasher<Map_t, 10>, ListNodeEqualityTester<Map_t>> cache;
 	ListNode<Map_t>* currentNode;
 	StackSlabAllocator<sizeof(ListNode<Map_t>), alignof(ListNode<Map_t>), (sizeof(ListNode<Map_t>) + sizeof(void*) > 204u ? 20u :
 		(4096u - sizeof(void*)) / sizeof(ListNode<Map_t>) * sizeof(ListNode<Map_t>))> allocator;
 
-#ifdef USE_HASH_MAP
-	HashMap<ListNode<Map_t>*, ListNodeHasher<Map_t, 10>, ListNodeEqualityTester<Map_t>> queueLookup;
-#endif
+	numOfStateExpansions = 0;
+
+	startTime = clock();
+
+	try
+	{
+
+		for (size_t i = 0; i != goalState.size(); ++i)
+		{
+			if (goalState[i] == '0')
+			{
+				goal.tiles[i] = 0;
+				goal.emptyPos = i;
+			}
+			else
+			{
+				goal.tiles[i] = goalState[i] - '0';
+			}
+		}
+
+		currentNode = (ListNode<Map_t>*)allocator.getNext();
+		new(currentNode) ListNode<Map_t>{ Map_t(), nullptr };
+		for (size_t i = 0; i != initialState.size(); ++i)
+		{
+			if (initialState[i] == '0')
+			{
+				currentNode->data.tiles[i] = 0;
+				currentNode->data.emptyPos = i;
+			}
+			else
+			{
+				currentNode->data.tiles[i] = initialState[i] - '0';
+			}
+		}
+
+		initializeHeuristic<heuristic>(currentNode->data, goal);
+
+		//States with an f value within the limit are searched depth first from the now list. The rest are kept in order on the later list
+		//and become the now list of the next iteration so the frontier doesn't have to be regenerated from the initial state.
+		Vector<ListNode<Map_t>*>* now = &fringe1;
+		Vector<ListNode<Map_t>*>* later = &fringe2;
+		now->push_back(currentNode);
+		cache.insert(currentNode);
+		unsigned int fLimit = currentNode->data.f;
+		maxQLength = 1;
+		ListNode<Map_t>* goalPath = nullptr;
+		bool cancelled = false;
+
+		while (!now->empty())
+		{
+			unsigned int fMin = infinity;
+			while (!now->empty())
+			{
+				if (shouldStop(cancellation, numOfStateExpansions))
+				{
+					cancelled = true;
+					break;
+				}
+				ListNode<Map_t>* currentPath = now->back();
+				now->pop_back();
+				Map_t& currentState = currentPath->data;
+				if (currentState.f == infinity) continue; //A shorter path to this state has been found
+				if (currentState.f > fLimit)
+				{
+					if (currentState.f < fMin) fMin = currentState.f;
+					later->push_back(currentPath);
+					continue;
+				}
+				if (currentState == goal)
+				{
+					goalPath = currentPath;
+					break;
+				}
+
+				//expand path
+				size_t emptyPos = currentState.emptyPos;
+				size_t x = emptyPos % width;
+				size_t y = emptyPos / width;
+				//Moving the empty tile back to where it just came from would only recreate the parent state
+				size_t parentPos = currentPath->next != nullptr ? currentPath->next->data.emptyPos : width * height;
+				if (y != 0u && emptyPos - width != parentPos)
+				{
+					expandFringe<heuristic>(currentState, currentPath, emptyPos - width, emptyPos, *now, cache, goal, allocator);
+				}
+				if (x != width - 1u && emptyPos + 1u != parentPos)
+				{
+					expandFringe<heuristic>(currentState, currentPath, emptyPos + 1u, emptyPos, *now, cache, goal, allocator);
+				}
+				if (y != height - 1u && emptyPos + width != parentPos)
+				{
+					expandFringe<heuristic>(currentState, currentPath, emptyPos + width, emptyPos, *now, cache, goal, allocator);
+				}
+				if (x != 0u && emptyPos - 1u != parentPos)
+				{
+					expandFringe<heuristic>(currentState, currentPath, emptyPos - 1u, emptyPos, *now, cache, goal, allocator);
+				}
+
+				if (now->size() + later->size() > (unsigned int)maxQLength)
+				{
+					maxQLength = (int)(now->size() + later->size());
+				}
+				++numOfStateExpansions;
+			}
+			if (goalPath != nullptr || cancelled) break;
+
+			std::reverse(later->begin(), later->end());
+			std::swap(now, later);
+			fLimit = fMin;
+		}
 
-	numOfDeletionsFromMiddleOfHeap = 0;
-	numOfLocalLoopsAvoided = 0;
-	numOfAttemptedNodeReExpansions = 0;
-	numOfStateExpansions = 0;
+		if (goalPath != nullptr)
+		{
+			path = packPath(goalPath);
+		}
+		else if (cancelled)
+		{
+			path = stoppedPath(cancellation);
+		}
+		else
+		{
+			path = "";
+		}
+
+	}
+	catch (std::bad_alloc)
+	{
+		path = "OOM";
+	}
 
+	actualRunningTime = ((float)(clock() - startTime) / CLOCKS_PER_SEC);
+
+	return path;
+}
+
+string fringeSearch(string const& initialState, string const& goalState, int &numOfStateExpansions, int& maxQLength, float &actualRunningTime,
+	heuristicFunction heuristic,
+	const CancellationToken* cancellation){
+
+	if (heuristic == heuristicFunction::manhattanDistance)
+	{
+		return fringeSearch<manhattanDistance>(initialState, goalState, numOfStateExpansions, maxQLength, actualRunningTime, cancellation);
+	}
+	else if (heuristic == heuristicFunction::linearConflict)
+	{
+		return fringeSearch<linearConflict>(initialState, goalState, numOfStateExpansions, maxQLength, actualRunningTime, cancellation);
+	}
+	else if (heuristic == heuristicFunction::walkingDistance)
+	{
+		return fringeSearch<walkingDistance>(initialState, goalState, numOfStateExpansions, maxQLength, actualRunningTime, cancellation);
+	}
+	else if (heuristic == heuristicFunction::patternDatabase)
+	{
+		return fringeSearch<patternDatabase>(initialState, goalState, numOfStateExpansions, maxQLength, actualRunningTime, cancellation);
+	}
+	else
+	{
+		return fringeSearch<misplacedTiles>(initialState, goalState, numOfStateExpansions, maxQLength, actualRunningTime, cancellation);
+	}
+}
+
+/*
+* Searches depth first below the state stored in current without going past states with an f value greater than bound.
+* Returns the smallest f value that was over bound so it can be used as the next bound.
+* Moves rejected by the MovePruningAutomaton are skipped which also stops the empty tile from moving back to where it came from.
+* If transpositions isn't null, states already reached in fewer moves this iteration are skipped, as are states reached in the same
+* number of moves with the same automaton state because their subtrees would be searched identically.
+* If perimeter isn't null the search stops at states on it and finishes the path with the moves from there to the goal.
+* If cancellation isn't null the search gives up once it is stopped, returning infinity without finding the goal.
+*/
+template<heuristicFunction heuristic, class Map, class Goal, class Automaton>
+unsigned int iterativeDeepeningAStar(ListNode<Map>& current, unsigned int pruningState, unsigned int bound, Goal& goal, const Automaton& automaton,
+	TranspositionTable* transpositions, const CancellationToken* cancellation, const Perimeter<Map::width, Map::height>* perimeter,
+	unsigned int initialHeuristic, std::string& path, bool& goalFound, int& numOfStateExpansions, int& maxQLength)
+{
+	constexpr size_t width = Map::width, height = Map::height;
+	constexpr unsigned int infinity = std::numeric_limits<unsigned int>::max();
+	if (current.data.f > bound) return current.data.f;
+	if (shouldStop(cancellation, numOfStateExpansions)) return infinity;
+	if (perimeter != nullptr)
+	{
+		const unsigned int distance = perimeter->distance(current.data);
+		if (distance != Perimeter<width, height>::outside)
+		{
+			const unsigned int f = (unsigned int)path.size() + distance - initialHeuristic;
+			if (f <= bound)
+			{
+				goalFound = true;
+				perimeter->appendPath(current.data, path);
+			}
+			return f;
+		}
+	}
+	else if (current.data == goal)
+	{
+		goalFound = true;
+		return current.data.f;
+	}
+	if (transpositions != nullptr)
+	{
+		const uint64_t key = packState(current.data);
+		const unsigned int depth = (unsigned int)path.size();
+		TranspositionTable::Entry* entry = transpositions->find(key);
+		if (entry == nullptr)
+		{
+			transpositions->insert(key, depth, pruningState);
+		}
+		else if (entry->g < depth || (entry->g == depth && entry->pruningState == pruningState))
+		{
+			return infinity;
+		}
+		else if (entry->g > depth)
+		{
+			entry->g = depth;
+			entry->pruningState = pruningState;
+		}
+	}
+	++numOfStateExpansions;
+	if (path.size() + 1u > (size_t)maxQLength)
+	{
+		maxQLength = (int)(path.size() + 1u);
+	}
+
+	const size_t emptyPos = current.data.emptyPos;
+	const size_t newPositions[4] = { emptyPos - width, emptyPos + 1u, emptyPos + width, emptyPos - 1u };
+	const bool canMove[4] = { emptyPos / width != 0u, emptyPos % width != width - 1u, emptyPos / width != height - 1u, emptyPos % width != 0u };
+	const char moves[4] = { 'U', 'R', 'D', 'L' };
+	unsigned int childPruningStates[4];
+	for (size_t direction = 0u; direction != 4u; ++direction)
+	{
+		childPruningStates[direction] = canMove[direction] ? automaton.next(pruningState, direction) : Automaton::pruned;
+	}
+
+	//Bidirectional pathmax: with an inconsistent heuristic every child is looked at first because a child's heuristic value minus one is
+	//also a lower bound for this state and the raised value might already be over bound.
+	unsigned int childF[4];
+	unsigned int childG[4];
+	HeuristicState<heuristic> childHeuristicStates[4];
+	if (!isConsistent(heuristic))
+	{
+		const unsigned int oldF = current.data.f;
+		const unsigned int oldG = current.data.g;
+		const HeuristicState<heuristic> oldHeuristicState = current.data;
+		unsigned int pathmaxF = oldF;
+		for (size_t direction = 0u; direction != 4u; ++direction)
+		{
+			if (childPruningStates[direction] == Automaton::pruned) continue;
+			makeMoveInPlace<heuristic>(current, goal, newPositions[direction]);
+			childF[direction] = current.data.f;
+			childG[direction] = current.data.g;
+			childHeuristicStates[direction] = current.data;
+			undoMoveInPlace(current, emptyPos, oldF, oldG, oldHeuristicState);
+			if ((int)(childF[direction] - 2u - pathmaxF) > 0) pathmaxF = childF[direction] - 2u;
+		}
+		pathmax(current.data, pathmaxF);
+		if (current.data.f > bound) return current.data.f;
+	}
+
+	const unsigned int oldF = current.data.f;
+	const unsigned int oldG = current.data.g;
+	const HeuristicState<heuristic> oldHeuristicState = current.data;
+	unsigned int nextBound = infinity;
+	for (size_t direction = 0u; direction != 4u; ++direction)
+	{
+		unsigned int childPruningState = childPruningStates[direction];
+		if (childPruningState == Automaton::pruned) continue;
+
+		if (isConsistent(heuristic))
+		{
+			makeMoveInPlace<heuristic>(current, goal, newPositions[direction]);
+		}
+		else
+		{
+			//Moving the empty tile back to a child position with the child's values makes the move without calculating them again
+			undoMoveInPlace(current, newPositions[direction], childF[direction], childG[direction], childHeuristicStates[direction]);
+			pathmax(current.data, oldF);
+		}
+		path.push_back(moves[direction]);
+		unsigned int childBound = iterativeDeepeningAStar<heuristic>(current, childPruningState, bound, goal, automaton, transpositions, cancellation,
+			perimeter, initialHeuristic, path, goalFound, numOfStateExpansions, maxQLength);
+		if (goalFound) return childBound;
+		path.pop_back();
+		undoMoveInPlace(current, emptyPos, oldF, oldG, oldHeuristicState);
+		if (childBound < nextBound) nextBound = childBound;
+	}
+	return nextBound;
+}
+
+template<heuristicFunction heuristic>
+string iterativeDeepeningAStar(string const& initialState, string const& goalState, int &numOfStateExpansions, int& maxQLength, float &actualRunningTime,
+	size_t transpositionTableSize, unsigned int perimeterDepth, const CancellationToken* cancellation)
+{
+	string path;
+	clock_t startTime;
+
+	constexpr size_t width = 3, height = 3;
+	using Map_t = MapWithHuristic<width, height, char, heuristic>;
+	Map<width, height> goal;
+	ListNode<Map_t> current{ Map_t(), nullptr };
+	const MovePruningAutomaton<width, height>& automaton = getMovePruningAutomaton<width, height>();
+
+	numOfStateExpansions = 0;
+	maxQLength = 1;
 
-	// cout << "------------------------------" << endl;
-	// cout << "<<aStar_ExpandedList>>" << endl;
-	// cout << "------------------------------" << endl;
-	
 	startTime = clock();
 
 	try
@@ -1021,137 +5102,326 @@ string aStar_ExpandedList(string const& initialState, string const& goalState, i
 			}
 		}
 
-		currentNode = (ListNode<Map_t>*)allocator.getNext();
-		new(currentNode) ListNode<Map_t>{ Map_t(), nullptr };
 		for (size_t i = 0; i != initialState.size(); ++i)
 		{
 			if (initialState[i] == '0')
 			{
-				currentNode->data.tiles[i] = 0;
-				currentNode->data.emptyPos = i;
+				current.data.tiles[i] = 0;
+				current.data.emptyPos = i;
 			}
 			else
 			{
-				currentNode->data.tiles[i] = initialState[i] - '0';
+				current.data.tiles[i] = initialState[i] - '0';
 			}
 		}
 
-		
-#ifdef USE_HASH_MAP
-		posiblePaths.push(QueueElement{ currentNode });
-		queueLookup.insert(posiblePaths.top().data);
-#else
-		posiblePaths.push(currentNode);
-#endif
-		maxQLength = 1;
-		bool goalFound = false;
+		initializeHeuristic<heuristic>(current.data, goal);
 
-		while (!posiblePaths.empty())
+		const std::shared_ptr<const Perimeter<width, height>> heldPerimeter = perimeterDepth != 0u ? getPerimeter(goal, perimeterDepth) : nullptr;
+		const Perimeter<width, height>* perimeter = heldPerimeter.get();
+		const unsigned int initialHeuristic = perimeter != nullptr ? heuristicValue<heuristic>(current.data, goal) : 0u;
+
+		std::unique_ptr<TranspositionTable> transpositions;
+		if (transpositionTableSize != 0u)
 		{
-			
-#ifdef USE_HASH_MAP
-			ListNode<MapWithHuristic<width, height>>* currentPath = posiblePaths.top().data;
-			queueLookup.erase(currentPath);
-#else
-			ListNode<MapWithHuristic<width, height>>* currentPath = posiblePaths.top();
-#endif
-			if (currentPath->data == goal)
+			transpositions.reset(new TranspositionTable(transpositionTableSize));
+		}
+
+		//Without a visited list iterative deepening would never return if the goal can't be reached
+		bool goalFound = false;
+		if (isSolvable(current.data, goal))
+		{
+			unsigned int bound = current.data.f;
+			while (!goalFound && (cancellation == nullptr || !cancellation->isCancelled()))
 			{
-				goalFound = true;
-				break;
+				if (transpositions) transpositions->startIteration();
+				bound = iterativeDeepeningAStar<heuristic>(current, automaton.start(current.data.emptyPos), bound, goal, automaton,
+					transpositions.get(), cancellation, perimeter, initialHeuristic, path, goalFound, numOfStateExpansions, maxQLength);
 			}
-			posiblePaths.pop();
-			MapWithHuristic<width, height>& currentState = currentPath->data;
+		}
 
-			//expand path
-			size_t emptyPos = currentState.emptyPos;
-			size_t x = emptyPos % width;
-			size_t y = emptyPos / width;
-			if (y != 0u)
+		if (!goalFound)
+		{
+			path = cancellation != nullptr && cancellation->isCancelled() ? stoppedPath(cancellation) : "";
+		}
+	}
+	catch (std::bad_alloc)
+	{
+		path = "OOM";
+	}
+
+	actualRunningTime = ((float)(clock() - startTime) / CLOCKS_PER_SEC);
+
+	return path;
+}
+
+string iterativeDeepeningAStar(string const& initialState, string const& goalState, int &numOfStateExpansions, int& maxQLength, float &actualRunningTime,
+	heuristicFunction heuristic, size_t transpositionTableSize, unsigned int perimeterDepth,
+	const CancellationToken* cancellation){
+
+	if (heuristic == heuristicFunction::manhattanDistance)
+	{
+		return iterativeDeepeningAStar<manhattanDistance>(initialState, goalState, numOfStateExpansions, maxQLength, actualRunningTime, transpositionTableSize, perimeterDepth, cancellation);
+	}
+	else if (heuristic == heuristicFunction::linearConflict)
+	{
+		return iterativeDeepeningAStar<linearConflict>(initialState, goalState, numOfStateExpansions, maxQLength, actualRunningTime, transpositionTableSize, perimeterDepth, cancellation);
+	}
+	else if (heuristic == heuristicFunction::walkingDistance)
+	{
+		return iterativeDeepeningAStar<walkingDistance>(initialState, goalState, numOfStateExpansions, maxQLength, actualRunningTime, transpositionTableSize, perimeterDepth, cancellation);
+	}
+	else if (heuristic == heuristicFunction::patternDatabase)
+	{
+		return iterativeDeepeningAStar<patternDatabase>(initialState, goalState, numOfStateExpansions, maxQLength, actualRunningTime, transpositionTableSize, perimeterDepth, cancellation);
+	}
+	else if (heuristic == heuristicFunction::dualPatternDatabase)
+	{
+		return iterativeDeepeningAStar<dualPatternDatabase>(initialState, goalState, numOfStateExpansions, maxQLength, actualRunningTime, transpositionTableSize, perimeterDepth, cancellation);
+	}
+	else
+	{
+		return iterativeDeepeningAStar<misplacedTiles>(initialState, goalState, numOfStateExpansions, maxQLength, actualRunningTime, transpositionTableSize, perimeterDepth, cancellation);
+	}
+}
+
+/*
+* A subtree searched by parallel iterative deepening A*: the state at its root, the moves that lead to it and the state of the
+* MovePruningAutomaton after them.
+*/
+template<class Map_t>
+struct SearchSubtree
+{
+	ListNode<Map_t> root;
+	std::string path;
+	unsigned int pruningState;
+};
+
+/*
+* Iterative deepening A* that splits the top of the search tree into about frontierSize subtrees with a breadth-first search and runs the
+* depth first search of each iteration on them with threadCount threads, or one per core if threadCount is 0.
+* Each thread is given an equal share of the subtrees. A thread that finishes its share steals subtrees from the others by claiming them
+* from the same atomic counter their owner uses. Any solution found is within the current bound so it is optimal, and the first thread to
+* find one stops the others through a shared flag.
+* Transposition tables aren't used because the threads would have to share one.
+*/
+template<heuristicFunction heuristic>
+string parallelIterativeDeepeningAStar(string const& initialState, string const& goalState, int &numOfStateExpansions, int& maxQLength,
+	float &actualRunningTime, unsigned int threadCount, const CancellationToken* cancellation)
+{
+	string path;
+
+	constexpr size_t width = 3, height = 3;
+	constexpr size_t frontierSize = 4096u;
+	constexpr unsigned int infinity = std::numeric_limits<unsigned int>::max();
+	using Map_t = MapWithHuristic<width, height, char, heuristic>;
+	using Subtree = SearchSubtree<Map_t>;
+	Map<width, height> goal;
+	ListNode<Map_t> current{ Map_t(), nullptr };
+	const MovePruningAutomaton<width, height>& automaton = getMovePruningAutomaton<width, height>();
+
+	numOfStateExpansions = 0;
+	maxQLength = 1;
+	if (threadCount == 0u) threadCount = std::thread::hardware_concurrency();
+	if (threadCount == 0u) threadCount = 1u;
+
+	//Wall clock time because clock() adds up the time of every thread
+	const auto startTime = std::chrono::steady_clock::now();
+
+	try
+	{
+
+		for (size_t i = 0; i != goalState.size(); ++i)
+		{
+			if (goalState[i] == '0')
 			{
-#ifdef USE_HASH_MAP
-				expandAStarExpanded<useManhattanDistance>(currentState, currentPath, emptyPos - width, emptyPos, posiblePaths,
-					expanded, goal, allocator, numOfDeletionsFromMiddleOfHeap, numOfAttemptedNodeReExpansions, queueLookup);
-#else
-				expandAStarExpanded<useManhattanDistance>(currentState, currentPath, emptyPos - width, emptyPos, posiblePaths,
-					expanded, goal, allocator, numOfDeletionsFromMiddleOfHeap, numOfAttemptedNodeReExpansions);
-#endif
+				goal.tiles[i] = 0;
+				goal.emptyPos = i;
 			}
-			if (x != width - 1u)
+			else
 			{
-#ifdef USE_HASH_MAP
-				expandAStarExpanded<useManhattanDistance>(currentState, currentPath, emptyPos + 1u, emptyPos, posiblePaths,
-					expanded, goal, allocator, numOfDeletionsFromMiddleOfHeap, numOfAttemptedNodeReExpansions, queueLookup);
-#else
-				expandAStarExpanded<useManhattanDistance>(currentState, currentPath, emptyPos + 1u, emptyPos, posiblePaths,
-					expanded, goal, allocator, numOfDeletionsFromMiddleOfHeap, numOfAttemptedNodeReExpansions);
-#endif
+				goal.tiles[i] = goalState[i] - '0';
 			}
-			if (y != height - 1u)
+		}
+
+		for (size_t i = 0; i != initialState.size(); ++i)
+		{
+			if (initialState[i] == '0')
 			{
-#ifdef USE_HASH_MAP
-				expandAStarExpanded<useManhattanDistance>(currentState, currentPath, emptyPos + width, emptyPos, posiblePaths,
-					expanded, goal, allocator, numOfDeletionsFromMiddleOfHeap, numOfAttemptedNodeReExpansions, queueLookup);
-#else
-				expandAStarExpanded<useManhattanDistance>(currentState, currentPath, emptyPos + width, emptyPos, posiblePaths,
-					expanded, goal, allocator, numOfDeletionsFromMiddleOfHeap, numOfAttemptedNodeReExpansions);
-#endif
+				current.data.tiles[i] = 0;
+				current.data.emptyPos = i;
 			}
-			if (x != 0u)
+			else
 			{
-#ifdef USE_HASH_MAP
-				expandAStarExpanded<useManhattanDistance>(currentState, currentPath, emptyPos - 1u, emptyPos, posiblePaths,
-					expanded, goal, allocator, numOfDeletionsFromMiddleOfHeap, numOfAttemptedNodeReExpansions, queueLookup);
-#else
-				expandAStarExpanded<useManhattanDistance>(currentState, currentPath, emptyPos - 1u, emptyPos, posiblePaths,
-					expanded, goal, allocator, numOfDeletionsFromMiddleOfHeap, numOfAttemptedNodeReExpansions);
-#endif
+				current.data.tiles[i] = initialState[i] - '0';
 			}
+		}
 
-			if (posiblePaths.size() > (unsigned int)maxQLength)
+		initializeHeuristic<heuristic>(current.data, goal);
+
+		//Without a visited list iterative deepening would never return if the goal can't be reached
+		bool goalFound = false;
+		bool stopped = false;
+		if (isSolvable(current.data, goal))
+		{
+			//The subtrees are the last level of a breadth-first search of the tree, so a goal found while building them is the closest one
+			const char moves[4] = { 'U', 'R', 'D', 'L' };
+			Vector<Subtree> subtrees;
+			subtrees.push_back(Subtree{ current, std::string(), automaton.start(current.data.emptyPos) });
+			size_t levelStart = 0u;
+			int frontierExpansions = 0;
+			goalFound = current.data == goal;
+			while (!goalFound && subtrees.size() - levelStart < frontierSize)
 			{
-				maxQLength = (int)posiblePaths.size();
+				const size_t levelEnd = subtrees.size();
+				for (size_t i = levelStart; i != levelEnd && !goalFound; ++i)
+				{
+					const size_t emptyPos = subtrees[i].root.data.emptyPos;
+					const size_t newPositions[4] = { emptyPos - width, emptyPos + 1u, emptyPos + width, emptyPos - 1u };
+					const bool canMove[4] = { emptyPos / width != 0u, emptyPos % width != width - 1u, emptyPos / width != height - 1u, emptyPos % width != 0u };
+					for (size_t direction = 0u; direction != 4u; ++direction)
+					{
+						const unsigned int pruningState = canMove[direction] ? automaton.next(subtrees[i].pruningState, direction) : MovePruningAutomaton<width, height>::pruned;
+						if (pruningState == MovePruningAutomaton<width, height>::pruned) continue;
+						Subtree child{ subtrees[i].root, subtrees[i].path, pruningState };
+						makeMoveInPlace<heuristic>(child.root, goal, newPositions[direction]);
+						if (!isConsistent(heuristic)) pathmax(child.root.data, subtrees[i].root.data.f);
+						child.path.push_back(moves[direction]);
+						if (child.root.data == goal)
+						{
+							path = child.path;
+							goalFound = true;
+							break;
+						}
+						subtrees.push_back(child);
+					}
+					++frontierExpansions;
+				}
+				levelStart = levelEnd;
 			}
-			expanded.insert(&currentState);
-			++numOfStateExpansions;
-		}
 
-		if (goalFound)
-		{
-#ifdef USE_HASH_MAP
-			path = packPath(posiblePaths.top().data);
-#else
-			path = packPath(posiblePaths.top());
-#endif
+			const size_t subtreeCount = subtrees.size() - levelStart;
+			const size_t sharePerThread = (subtreeCount + threadCount - 1u) / threadCount;
+			unsigned int bound = current.data.f;
+			std::unique_ptr<std::atomic<size_t>[]> nextSubtree(new std::atomic<size_t>[threadCount]);
+			//Cancelled by the thread that finds the goal, or along with the caller's token
+			CancellationToken cancelled(cancellation);
+			bool solved = false;
+			std::atomic<bool> outOfMemory(false);
+			std::atomic<int> expansions(0);
+			std::atomic<int> longestPath((int)subtrees[subtrees.size() - 1u].path.size() + 1);
+			std::mutex resultMutex;
+			while (!goalFound && bound != infinity)
+			{
+				for (unsigned int i = 0u; i != threadCount; ++i)
+				{
+					nextSubtree[i].store(i * sharePerThread, std::memory_order_relaxed);
+				}
+				std::atomic<unsigned int> nextThread(0u);
+				std::atomic<unsigned int> nextBound(infinity);
+				runOnThreads(threadCount, [&]()
+				{
+					const unsigned int self = nextThread.fetch_add(1u, std::memory_order_relaxed);
+					int expanded = 0, deepest = 1;
+					unsigned int smallestOverBound = infinity;
+					try
+					{
+						//Start with this thread's own share then steal from the others in turn
+						for (unsigned int victim = self, stolen = 0u; stolen != threadCount && !cancelled.isCancelled();
+							victim = (victim + 1u) % threadCount, ++stolen)
+						{
+							const size_t shareEnd = (victim + 1u) * sharePerThread < subtreeCount ? (victim + 1u) * sharePerThread : subtreeCount;
+							for (size_t i = nextSubtree[victim].fetch_add(1u, std::memory_order_relaxed); i < shareEnd;
+								i = nextSubtree[victim].fetch_add(1u, std::memory_order_relaxed))
+							{
+								const Subtree& subtree = subtrees[levelStart + i];
+								ListNode<Map_t> root = subtree.root;
+								std::string subtreePath = subtree.path;
+								bool found = false;
+								const unsigned int childBound = iterativeDeepeningAStar<heuristic>(root, subtree.pruningState, bound, goal, automaton,
+									nullptr, &cancelled, nullptr, 0u, subtreePath, found, expanded, deepest);
+								if (found)
+								{
+									std::lock_guard<std::mutex> lock(resultMutex);
+									if (!solved)
+									{
+										path = subtreePath;
+										solved = true;
+										cancelled.cancel();
+									}
+									break;
+								}
+								if (childBound < smallestOverBound) smallestOverBound = childBound;
+								if (cancelled.isCancelled()) break;
+							}
+						}
+					}
+					catch (std::bad_alloc)
+					{
+						outOfMemory.store(true, std::memory_order_relaxed);
+						cancelled.cancel();
+					}
+					expansions.fetch_add(expanded, std::memory_order_relaxed);
+					for (int longest = longestPath.load(std::memory_order_relaxed);
+						deepest > longest && !longestPath.compare_exchange_weak(longest, deepest, std::memory_order_relaxed);)
+					{
+					}
+					for (unsigned int smallest = nextBound.load(std::memory_order_relaxed);
+						smallestOverBound < smallest && !nextBound.compare_exchange_weak(smallest, smallestOverBound, std::memory_order_relaxed);)
+					{
+					}
+				});
+				if (outOfMemory.load(std::memory_order_relaxed)) throw std::bad_alloc();
+				goalFound = solved;
+				stopped = !solved && cancelled.isCancelled();
+				if (stopped) break;
+				bound = nextBound.load(std::memory_order_relaxed);
+			}
+			numOfStateExpansions = frontierExpansions + expansions.load(std::memory_order_relaxed);
+			maxQLength = longestPath.load(std::memory_order_relaxed);
 		}
-		else
+
+		if (!goalFound)
 		{
-			path = "";
+			path = stopped ? stoppedPath(cancellation) : "";
 		}
-
 	}
 	catch (std::bad_alloc)
 	{
 		path = "OOM";
 	}
 
-	actualRunningTime = ((float)(clock() - startTime) / CLOCKS_PER_SEC);
+	actualRunningTime = std::chrono::duration<float>(std::chrono::steady_clock::now() - startTime).count();
 
 	return path;
 }
-	
 
-string aStar_ExpandedList(string const& initialState, string const& goalState, int &numOfStateExpansions, int& maxQLength, float &actualRunningTime,
-	int &numOfDeletionsFromMiddleOfHeap, int &numOfLocalLoopsAvoided, int &numOfAttemptedNodeReExpansions, heuristicFunction heuristic){
-											 
+string parallelIterativeDeepeningAStar(string const& initialState, string const& goalState, int &numOfStateExpansions, int& maxQLength, float &actualRunningTime,
+	heuristicFunction heuristic, unsigned int threadCount,
+	const CancellationToken* cancellation){
+
 	if (heuristic == heuristicFunction::manhattanDistance)
 	{
-		return aStar_ExpandedList<true>(initialState, goalState, numOfStateExpansions, maxQLength, actualRunningTime,
-			numOfDeletionsFromMiddleOfHeap, numOfLocalLoopsAvoided, numOfAttemptedNodeReExpansions);
+		return parallelIterativeDeepeningAStar<manhattanDistance>(initialState, goalState, numOfStateExpansions, maxQLength, actualRunningTime, threadCount, cancellation);
+	}
+	else if (heuristic == heuristicFunction::linearConflict)
+	{
+		return parallelIterativeDeepeningAStar<linearConflict>(initialState, goalState, numOfStateExpansions, maxQLength, actualRunningTime, threadCount, cancellation);
+	}
+	else if (heuristic == heuristicFunction::walkingDistance)
+	{
+		return parallelIterativeDeepeningAStar<walkingDistance>(initialState, goalState, numOfStateExpansions, maxQLength, actualRunningTime, threadCount, cancellation);
+	}
+	else if (heuristic == heuristicFunction::patternDatabase)
+	{
+		return parallelIterativeDeepeningAStar<patternDatabase>(initialState, goalState, numOfStateExpansions, maxQLength, actualRunningTime, threadCount, cancellation);
+	}
+	else if (heuristic == heuristicFunction::dualPatternDatabase)
+	{
+		return parallelIterativeDeepeningAStar<dualPatternDatabase>(initialState, goalState, numOfStateExpansions, maxQLength, actualRunningTime, threadCount, cancellation);
 	}
 	else
 	{
-		return aStar_ExpandedList<false>(initialState, goalState, numOfStateExpansions, maxQLength, actualRunningTime,
-			numOfDeletionsFromMiddleOfHeap, numOfLocalLoopsAvoided, numOfAttemptedNodeReExpansions);
+		return parallelIterativeDeepeningAStar<misplacedTiles>(initialState, goalState, numOfStateExpansions, maxQLength, actualRunningTime, threadCount, cancellation);
 	}
 }
\ No newline at end of file
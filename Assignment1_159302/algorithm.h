@@ -2,6 +2,8 @@
 #ifndef __ALGORITHM_H__
 #define __ALGORITHM_H__
 
+#include <atomic>
+#include <chrono>
 #include <ctime>
 #include <string>
 #include <iostream>
@@ -11,14 +13,125 @@
 #include "puzzle.h"
 
 
+//Stops a search early, either when another thread no longer needs its answer or when a deadline passes. Every search takes one as its
+//last parameter and looks at it every so often. A search that is stopped returns "TIMEOUT" if the deadline passed and "CANCELLED" otherwise,
+//along with the expansions, queue length and time up to then.
+//A token made with a parent is also stopped when the parent is, which lets a search that runs others stop them itself.
+class CancellationToken
+{
+	std::atomic<bool> cancelled;
+	mutable std::atomic<bool> timedOut;
+	const CancellationToken* parent;
+	bool hasDeadline;
+	std::chrono::steady_clock::time_point deadline;
+public:
+	explicit CancellationToken(const CancellationToken* parent = nullptr) noexcept : cancelled(false), timedOut(false), parent(parent), hasDeadline(false) {}
+
+	explicit CancellationToken(std::chrono::steady_clock::duration timeLimit) noexcept : cancelled(false), timedOut(false), parent(nullptr),
+		hasDeadline(true), deadline(std::chrono::steady_clock::now() + timeLimit) {}
+
+	CancellationToken(const CancellationToken&) = delete;
+	CancellationToken& operator=(const CancellationToken&) = delete;
+
+	void cancel() noexcept
+	{
+		cancelled.store(true, std::memory_order_relaxed);
+	}
+
+	//Reads the clock if there is a deadline, so searches only call it every few thousand expansions
+	bool isCancelled() const noexcept
+	{
+		if (cancelled.load(std::memory_order_relaxed) || timedOut.load(std::memory_order_relaxed)) return true;
+		if (hasDeadline && std::chrono::steady_clock::now() >= deadline)
+		{
+			timedOut.store(true, std::memory_order_relaxed);
+			return true;
+		}
+		return parent != nullptr && parent->isCancelled();
+	}
+
+	bool hasTimedOut() const noexcept
+	{
+		return timedOut.load(std::memory_order_relaxed) || (parent != nullptr && parent->hasTimedOut());
+	}
+};
+
 //Function prototypes
-string progressiveDeepeningSearch_No_VisitedList(string const& initialState, string const& goalState, int &numOfStateExpansions, int& maxQLength, float &actualRunningTime, int ultimateMaxDepth);
-string progressiveDeepeningSearch_with_NonStrict_VisitedList(string const& initialState, string const& goalState, int &numOfStateExpansions, int& maxQLength, float &actualRunningTime, int ultimateMaxDepth);
+string progressiveDeepeningSearch_No_VisitedList(string const& initialState, string const& goalState, int &numOfStateExpansions, int& maxQLength, float &actualRunningTime, int ultimateMaxDepth,
+                               const CancellationToken* cancellation = nullptr);
+string progressiveDeepeningSearch_with_NonStrict_VisitedList(string const& initialState, string const& goalState, int &numOfStateExpansions, int& maxQLength, float &actualRunningTime, int ultimateMaxDepth,
+                               const CancellationToken* cancellation = nullptr);
+
+string breadthFirstSearch_with_VisitedList(string const& initialState, string const& goalState, int &numOfStateExpansions, int& maxQLength, float &actualRunningTime,
+                               const CancellationToken* cancellation = nullptr);
+string breadthFirstSearch(string const& initialState, string const& goalState, int &numOfStateExpansions, int& maxQLength, float &actualRunningTime,
+                               const CancellationToken* cancellation = nullptr);
+
+//Expands each level of the search on threadCount threads, or one per core if threadCount is 0
+string breadthFirstSearch_with_VisitedList_Parallel(string const& initialState, string const& goalState, int &numOfStateExpansions, int& maxQLength, float &actualRunningTime,
+                               unsigned int threadCount = 0u, const CancellationToken* cancellation = nullptr);
 
-string breadthFirstSearch_with_VisitedList(string const& initialState, string const& goalState, int &numOfStateExpansions, int& maxQLength, float &actualRunningTime);
-string breadthFirstSearch(string const& initialState, string const& goalState, int &numOfStateExpansions, int& maxQLength, float &actualRunningTime);
+//Searches forwards from the initial state and backwards from the goal a level at a time until the two searches meet
+string bidirectionalBreadthFirstSearch(string const& initialState, string const& goalState, int &numOfStateExpansions, int& maxQLength, float &actualRunningTime,
+                               const CancellationToken* cancellation = nullptr);
 
+//A perimeterDepth of 0 searches all the way to the goal, otherwise the search stops at states that many moves or fewer from the goal
+//and finishes with their exact distances. The A*, recursive best-first search and iterative deepening A* engines all support it.
 string aStar_ExpandedList(string const& initialState, string const& goalState, int &numOfStateExpansions, int& maxQLength, 
-                               float &actualRunningTime, int &numOfDeletionsFromMiddleOfHeap, int &numOfLocalLoopsAvoided, int &numOfAttemptedNodeReExpansions, heuristicFunction heuristic);
+                               float &actualRunningTime, int &numOfDeletionsFromMiddleOfHeap, int &numOfLocalLoopsAvoided, int &numOfAttemptedNodeReExpansions, heuristicFunction heuristic,
+                               unsigned int perimeterDepth = 0u, const CancellationToken* cancellation = nullptr);
+
+//Hash distributed A* on threadCount threads, or one per core if threadCount is 0
+string hashDistributedAStar(string const& initialState, string const& goalState, int &numOfStateExpansions, int& maxQLength, 
+                               float &actualRunningTime, int &numOfDeletionsFromMiddleOfHeap, int &numOfLocalLoopsAvoided, int &numOfAttemptedNodeReExpansions, heuristicFunction heuristic,
+                               unsigned int threadCount = 0u, const CancellationToken* cancellation = nullptr);
+
+//A* on threadCount threads, or one per core if threadCount is 0, sharing a relaxed open list and a table of the best paths found
+string multiQueueAStar(string const& initialState, string const& goalState, int &numOfStateExpansions, int& maxQLength, 
+                               float &actualRunningTime, int &numOfDeletionsFromMiddleOfHeap, int &numOfLocalLoopsAvoided, int &numOfAttemptedNodeReExpansions, heuristicFunction heuristic,
+                               unsigned int threadCount = 0u, const CancellationToken* cancellation = nullptr);
+
+//Hash distributed A* on processCount worker processes, or one per core if processCount is 0, that exchange states over UNIX domain sockets.
+//Worker processes need fork so elsewhere it runs hash distributed A* on that many threads.
+string distributedAStar(string const& initialState, string const& goalState, int &numOfStateExpansions, int& maxQLength, 
+                               float &actualRunningTime, int &numOfDeletionsFromMiddleOfHeap, int &numOfLocalLoopsAvoided, int &numOfAttemptedNodeReExpansions, heuristicFunction heuristic,
+                               unsigned int processCount = 0u, const CancellationToken* cancellation = nullptr);
+
+//Evaluates a chain of heuristics ending with heuristic, cheapest first, only as states reach the top of the open list
+string lazyAStar_ExpandedList(string const& initialState, string const& goalState, int &numOfStateExpansions, int& maxQLength, 
+                               float &actualRunningTime, int &numOfDeletionsFromMiddleOfHeap, int &numOfLocalLoopsAvoided, int &numOfAttemptedNodeReExpansions, heuristicFunction heuristic,
+                               const CancellationToken* cancellation = nullptr);
+
+//Enhanced partial expansion A*, only generates the children of a state whose f value equals the state's stored f value
+string partialExpansionAStar_ExpandedList(string const& initialState, string const& goalState, int &numOfStateExpansions, int& maxQLength, 
+                               float &actualRunningTime, int &numOfDeletionsFromMiddleOfHeap, int &numOfLocalLoopsAvoided, int &numOfAttemptedNodeReExpansions, heuristicFunction heuristic,
+                               const CancellationToken* cancellation = nullptr);
+
+string recursiveBestFirstSearch(string const& initialState, string const& goalState, int &numOfStateExpansions, int& maxQLength, float &actualRunningTime,
+                               heuristicFunction heuristic, unsigned int perimeterDepth = 0u, const CancellationToken* cancellation = nullptr);
+
+string fringeSearch(string const& initialState, string const& goalState, int &numOfStateExpansions, int& maxQLength, float &actualRunningTime,
+                               heuristicFunction heuristic, const CancellationToken* cancellation = nullptr);
+
+//A transpositionTableSize of 0 searches without a transposition table, otherwise it is the table's size in bytes
+string iterativeDeepeningAStar(string const& initialState, string const& goalState, int &numOfStateExpansions, int& maxQLength, float &actualRunningTime,
+                               heuristicFunction heuristic, size_t transpositionTableSize = 0u, unsigned int perimeterDepth = 0u,
+                               const CancellationToken* cancellation = nullptr);
+
+//Splits the top of the search tree into subtrees that threadCount threads, or one per core if threadCount is 0, search each iteration
+string parallelIterativeDeepeningAStar(string const& initialState, string const& goalState, int &numOfStateExpansions, int& maxQLength, float &actualRunningTime,
+                               heuristicFunction heuristic, unsigned int threadCount = 0u, const CancellationToken* cancellation = nullptr);
+
+//Races A* and iterative deepening A* using heuristic against bidirectional breadth-first search, each on its own thread, and returns the
+//first answer found, cancelling the other searches. The counts are totals over all three searches and the time is the time until the answer.
+string portfolioSearch(string const& initialState, string const& goalState, int &numOfStateExpansions, int& maxQLength, 
+                               float &actualRunningTime, int &numOfDeletionsFromMiddleOfHeap, int &numOfLocalLoopsAvoided, int &numOfAttemptedNodeReExpansions, heuristicFunction heuristic,
+                               const CancellationToken* cancellation = nullptr);
+
+//Estimates how hard the puzzle is from the Manhattan distance of the initial state, the parity of the tiles and a sample of random states,
+//then solves it with whichever of iterative deepening A*, A* or a table of every state's distance to the goal it expects to be quickest
+string autoSearch(string const& initialState, string const& goalState, int &numOfStateExpansions, int& maxQLength, 
+                               float &actualRunningTime, int &numOfDeletionsFromMiddleOfHeap, int &numOfLocalLoopsAvoided, int &numOfAttemptedNodeReExpansions,
+                               const CancellationToken* cancellation = nullptr);
 
 #endif
\ No newline at end of file
@@ -112,6 +112,11 @@ int Puzzle::h(heuristicFunction hFunction){
 		        h = sum; 					
 		        break;         
 		           
+		default:
+		        //The other heuristics are only computed by the search engines in algorithm.cpp, which never call Puzzle::h
+		        h = 0;
+		        break;
+		           
 	};
 	
 	return h;
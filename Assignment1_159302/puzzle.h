@@ -4,7 +4,7 @@
 using namespace std;
 
 
-enum heuristicFunction{misplacedTiles, manhattanDistance};
+enum heuristicFunction{misplacedTiles, manhattanDistance, linearConflict, walkingDistance, patternDatabase, dualPatternDatabase};
 
 
 class Puzzle{
@@ -10,6 +10,37 @@ cls
 @echo (4) PDS_NonStrict_VList
 @echo (5) aStar_ExpList_MisplacedTiles
 @echo (6) aStar_ExpList_Manhattan
+@echo (7) RBFS_MisplacedTiles
+@echo (8) RBFS_Manhattan
+@echo (9) Fringe_MisplacedTiles
+@echo (10) Fringe_Manhattan
+@echo (11) IDAStar_MisplacedTiles
+@echo (12) IDAStar_Manhattan
+@echo (13) IDAStar_TT_MisplacedTiles
+@echo (14) IDAStar_TT_Manhattan
+@echo (15) aStar_ExpList_LinearConflict
+@echo (16) IDAStar_LinearConflict
+@echo (17) aStar_ExpList_WalkingDistance
+@echo (18) IDAStar_WalkingDistance
+@echo (19) aStar_ExpList_PatternDatabase
+@echo (20) IDAStar_PatternDatabase
+@echo (21) aStar_ExpList_DualPatternDatabase
+@echo (22) IDAStar_DualPatternDatabase
+@echo (23) LazyAStar_ExpList_WalkingDistance
+@echo (24) LazyAStar_ExpList_PatternDatabase
+@echo (25) EPEAStar_ExpList_MisplacedTiles
+@echo (26) EPEAStar_ExpList_Manhattan
+@echo (27) aStar_ExpList_Manhattan_Perimeter
+@echo (28) RBFS_Manhattan_Perimeter
+@echo (29) IDAStar_Manhattan_Perimeter
+@echo (30) Breadth_First_Search_VList_Parallel
+@echo (31) HDAStar_Manhattan
+@echo (32) IDAStar_Parallel_Manhattan
+@echo (33) Distributed_AStar_Manhattan
+@echo (34) MultiQueue_AStar_Manhattan
+@echo (35) Bidirectional_BFS
+@echo (36) Portfolio
+@echo (37) Auto
 
 echo.
 set /p selection="Select Algorithm: "
@@ -40,6 +71,68 @@ if %selection% == 1 (
     set param1= single_run aStar_ExpList_MisplacedTiles
 ) else if %selection% == 6 (
     set param1= single_run aStar_ExpList_Manhattan
+) else if %selection% == 7 (
+    set param1= single_run RBFS_MisplacedTiles
+) else if %selection% == 8 (
+    set param1= single_run RBFS_Manhattan
+) else if %selection% == 9 (
+    set param1= single_run Fringe_MisplacedTiles
+) else if %selection% == 10 (
+    set param1= single_run Fringe_Manhattan
+) else if %selection% == 11 (
+    set param1= single_run IDAStar_MisplacedTiles
+) else if %selection% == 12 (
+    set param1= single_run IDAStar_Manhattan
+) else if %selection% == 13 (
+    set param1= single_run IDAStar_TT_MisplacedTiles
+) else if %selection% == 14 (
+    set param1= single_run IDAStar_TT_Manhattan
+) else if %selection% == 15 (
+    set param1= single_run aStar_ExpList_LinearConflict
+) else if %selection% == 16 (
+    set param1= single_run IDAStar_LinearConflict
+) else if %selection% == 17 (
+    set param1= single_run aStar_ExpList_WalkingDistance
+) else if %selection% == 18 (
+    set param1= single_run IDAStar_WalkingDistance
+) else if %selection% == 19 (
+    set param1= single_run aStar_ExpList_PatternDatabase
+) else if %selection% == 20 (
+    set param1= single_run IDAStar_PatternDatabase
+) else if %selection% == 21 (
+    set param1= single_run aStar_ExpList_DualPatternDatabase
+) else if %selection% == 22 (
+    set param1= single_run IDAStar_DualPatternDatabase
+) else if %selection% == 23 (
+    set param1= single_run LazyAStar_ExpList_WalkingDistance
+) else if %selection% == 24 (
+    set param1= single_run LazyAStar_ExpList_PatternDatabase
+) else if %selection% == 25 (
+    set param1= single_run EPEAStar_ExpList_MisplacedTiles
+) else if %selection% == 26 (
+    set param1= single_run EPEAStar_ExpList_Manhattan
+) else if %selection% == 27 (
+    set param1= single_run aStar_ExpList_Manhattan_Perimeter
+) else if %selection% == 28 (
+    set param1= single_run RBFS_Manhattan_Perimeter
+) else if %selection% == 29 (
+    set param1= single_run IDAStar_Manhattan_Perimeter
+) else if %selection% == 30 (
+    set param1= single_run Breadth_First_Search_VList_Parallel
+) else if %selection% == 31 (
+    set param1= single_run HDAStar_Manhattan
+) else if %selection% == 32 (
+    set param1= single_run IDAStar_Parallel_Manhattan
+) else if %selection% == 33 (
+    set param1= single_run Distributed_AStar_Manhattan
+) else if %selection% == 34 (
+    set param1= single_run MultiQueue_AStar_Manhattan
+) else if %selection% == 35 (
+    set param1= single_run Bidirectional_BFS
+) else if %selection% == 36 (
+    set param1= single_run Portfolio
+) else if %selection% == 37 (
+    set param1= single_run Auto
 )
 
 